@@ -69,6 +69,8 @@ double DoubleStereographic::getOriginLatitude() {
 
 
 
+static inline double clenshaw_sin(double const *c, double sin2x, double cos2x);
+
 int DoubleStereographic::spheroidChanged() {
     if (f <= 0) return PROJ_E_SPHEROID;
 
@@ -91,27 +93,94 @@ int DoubleStereographic::spheroidChanged() {
         tan((PI/4) + slat0 / 2) 
       / pow(tan((PI/4) + lat0 / 2) * pow( (1.0-e*sin(lat0))/(1.0+e*sin(lat0)), e/2), c1)
     );
+    lnc2 = log(c2);
+    
+    // Series in sin(2j lat) between geodetic and conformal latitude, 
+    // to 6th order in the third flattening n (as in Karney, 2011).
+    // With them, and the isometric latitude of the conformal sphere,
+    // neither direction needs pow or iteration; see below.
+    double n = f / (2 - f);
+    double n2 = n*n, n3 = n2*n, n4 = n3*n, n5 = n4*n, n6 = n5*n;
+    
+    chiSeries[0] = -n*2 + n2*2/3 + n3*4/3 - n4*82/45 + n5*32/45 + n6*4642/4725;
+    chiSeries[1] = n2*5/3 - n3*16/15 - n4*13/9 + n5*904/315 - n6*1522/945;
+    chiSeries[2] = -n3*26/15 + n4*34/21 + n5*8/5 - n6*12686/2835;
+    chiSeries[3] = n4*1237/630 - n5*12/5 - n6*24832/14175;
+    chiSeries[4] = -n5*734/315 + n6*109598/31185;
+    chiSeries[5] = n6*444337/155925;
+    
+    latSeries[0] = n*2 - n2*2/3 - n3*2 + n4*116/45 + n5*26/45 - n6*2854/675;
+    latSeries[1] = n2*7/3 - n3*8/5 - n4*227/45 + n5*2704/315 + n6*2323/945;
+    latSeries[2] = n3*56/15 - n4*136/35 - n5*1262/105 + n6*73814/2835;
+    latSeries[3] = n4*4279/630 - n5*332/35 - n6*399572/14175;
+    latSeries[4] = n5*4174/315 - n6*144838/6237;
+    latSeries[5] = n6*601676/22275;
+    
+    chi0 = lat0 + clenshaw_sin(chiSeries, sin(2*lat0), cos(2*lat0));
+    psi0 = 0.5 * log((1+sin(chi0))/(1-sin(chi0)));
 
     return PROJ_SUCCESS;
 }
 
 
+/*
+  Both directions go through the conformal latitude chi, by the series 
+  above, and the isometric latitude of the sphere:
+  
+    ln tan(pi/4 + slat/2) = c1 * atanh(sin chi) + ln c2
+  
+  which is the same relation as the chain of tan and pow in the usual
+  formulae.  Given g = ln tan(pi/4 + x/2), sin x = tanh g and cos x
+  = sech g, so the sphere latitude never needs tan or atan, and the
+  inverse is direct rather than iterated.
+*/
+
+// Sum c[0] sin(2x) + ... + c[5] sin(12x), given sin and cos of 2x.
+static inline double clenshaw_sin(double const *c, double sin2x, double cos2x) {
+    double a2 = 2 * cos2x;
+    double b1 = 0, b2 = 0;
+    for (int j = 5; j >= 0; --j) {
+        double b0 = a2 * b1 - b2 + c[j];
+        b2 = b1;
+        b1 = b0;
+    }
+    return sin2x * b1;
+}
+
+// sin and cos of x, given g = ln tan(pi/4 + x/2)
+static inline void sin_cos_gd(double g, double *sin_x, double *cos_x) {
+    double u = exp(-fabs(g));
+    double u2 = u * u;
+    *sin_x = (g < 0 ? u2 - 1 : 1 - u2) / (1 + u2);
+    *cos_x = 2 * u / (1 + u2);
+}
+
 int DoubleStereographic::fromLatLong(double *xy, int numPoints)
 {
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = fromLatLongAVX512(PointPairs(xy), numPoints); break;
+      case SIMD_AVX2: done = fromLatLongAVX2(PointPairs(xy), numPoints); break;
+      case SIMD_SSE2: done = fromLatLongSSE2(PointPairs(xy), numPoints); break;
+    }
+    xy += 2 * done;
+    numPoints -= done;
+#endif
     double lon, lat;
-    double slon, slat, delta_slon;
+    double sin_2lat, cos_2lat, sin_chi;
     double sin_delta_slon, cos_delta_slon, sin_slat, cos_slat;
 
     for (int i=0;i<numPoints;++i,xy+=2) {
         lon = xy[0] * (PI/180);
         lat = xy[1] * (PI/180);
       
-        slon = c1*lon;
-      
-        slat = 2.0 * (atan(c2 * pow(tan((PI/4)+lat/2) * pow((1.0-e*sin(lat))/(1.0+e*sin(lat)), e/2),c1)) - (PI/4));
+        // conformal latitude, then onto the sphere
+        sin_cos(2*lat, &sin_2lat, &cos_2lat);
+        sin_chi = sin(lat + clenshaw_sin(chiSeries, sin_2lat, cos_2lat));
+        sin_cos_gd(c1 * 0.5 * log((1+sin_chi)/(1-sin_chi)) + lnc2, &sin_slat, &cos_slat);
 
-        sin_cos(slon-slon0, &sin_delta_slon, &cos_delta_slon);
-        sin_cos(slat, &sin_slat, &cos_slat);
+        sin_cos(c1*lon-slon0, &sin_delta_slon, &cos_delta_slon);
       
         double common_terms = (2 * k0 * r) / (1.0  +  sin_slat*sin_slat0  +  cos_slat * cos_slat0 * cos_delta_slon);
    
@@ -123,14 +192,55 @@ int DoubleStereographic::fromLatLong(double *xy, int numPoints)
 }
 
 
+// The -fast tier, where there are SIMD kernels for it
+int DoubleStereographic::fromLatLongFast(double *xy, int numPoints)
+{
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = fastFromLatLongAVX512(PointPairs(xy), numPoints); break;
+      case SIMD_AVX2: done = fastFromLatLongAVX2(PointPairs(xy), numPoints); break;
+      case SIMD_SSE2: done = fastFromLatLongSSE2(PointPairs(xy), numPoints); break;
+    }
+    xy += 2 * done;
+    numPoints -= done;
+#endif
+    return fromLatLong(xy, numPoints);
+}
+
+int DoubleStereographic::toLatLongFast(double *xy, int numPoints)
+{
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = fastToLatLongAVX512(PointPairs(xy), numPoints); break;
+      case SIMD_AVX2: done = fastToLatLongAVX2(PointPairs(xy), numPoints); break;
+      case SIMD_SSE2: done = fastToLatLongSSE2(PointPairs(xy), numPoints); break;
+    }
+    xy += 2 * done;
+    numPoints -= done;
+#endif
+    return toLatLong(xy, numPoints);
+}
+
+
 int DoubleStereographic::toLatLong(double *xy, int numPoints)
 {
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = toLatLongAVX512(PointPairs(xy), numPoints); break;
+      case SIMD_AVX2: done = toLatLongAVX2(PointPairs(xy), numPoints); break;
+      case SIMD_SSE2: done = toLatLongSSE2(PointPairs(xy), numPoints); break;
+    }
+    xy += 2 * done;
+    numPoints -= done;
+#endif
 
-    double dif;
     double sin_delta, cos_delta;
+    double sin_chi, cos_chi;
     
     const double errmax = highPrecision ? epsilon / 100000 : epsilon;
-    const int maxiter = highPrecision ? 1000 : 100;
   
     for (int i=0;i<numPoints;++i,xy+=2) {
 
@@ -150,47 +260,19 @@ int DoubleStereographic::toLatLong(double *xy, int numPoints)
         
         sin_cos( 2.0*atan(0.5*s/r), &sin_delta, &cos_delta);
         
-        double slat = asin(sin_slat0*cos_delta + sin_delta*cos_slat0*sin_beta);
+        double sin_slat = sin_slat0*cos_delta + sin_delta*cos_slat0*sin_beta;
+        double cos_slat = sqrt(1 - sin_slat*sin_slat);
     
-        double slon = slon0 + asin( sin_delta*cos_beta / cos(slat) );
+        double slon = slon0 + asin( sin_delta*cos_beta / cos_slat );
         
         // longitude is easy
         double lon = slon/c1;
 
-        // Latitude requires an iterative method to get from latitude on the 
-        // sphere (slat) to the latitude on the spheroid (lat).
-
-        double tan_45_plus_half_slat = tan((PI/4) + slat/2);
+        // and so is latitude, back through the conformal latitude
+        sin_cos_gd((0.5 * log((1+sin_slat)/(1-sin_slat)) - lnc2) / c1, &sin_chi, &cos_chi);
         
-        double lat = slat;
-        double dif;
-        
-        int iter = 0;
-        do {
-            double e_sin_lat = e * sin(lat);
-            double sec_45_plus_half_lat = 1.0 / cos((PI/4) + lat/2);
-            double tan_45_plus_half_lat = tan((PI/4) + lat/2);
-      
-            double fun = c2 * pow( 
-                tan_45_plus_half_lat * pow( (1.0-e_sin_lat)/(1.0+e_sin_lat), e/2), c1
-            ) - tan_45_plus_half_slat;
-      
-            double fundif = (
-                (c1*c2)
-              * pow( tan_45_plus_half_lat * pow( (1.0-e_sin_lat)/(1.0+e_sin_lat), e/2), (c1-1.0) )
-              * pow( (1.0-e_sin_lat)/(1.0+e_sin_lat),e/2)
-              * (
-                    0.5 * square(sec_45_plus_half_lat)
-                  - e_squared * cos(lat) * tan_45_plus_half_lat / (1.0-square(e_sin_lat))
-                )
-            );
-            
-            dif=fun/fundif;
-            lat-=dif;
-        } while ((fabs(dif) > errmax) && (++iter < maxiter));
-        // repeat, getting closer each time, until further iterations don't matter
-        // short circuit if too many iterations, e.g. unprojecting infinity doesn't
-        // work
+        double lat = atan2(sin_chi, cos_chi) + clenshaw_sin(latSeries, 
+            2 * sin_chi * cos_chi, (cos_chi - sin_chi) * (cos_chi + sin_chi));
     
         xy[0] = lon * (180/PI);
         xy[1] = lat * (180/PI);
@@ -199,3 +281,57 @@ int DoubleStereographic::toLatLong(double *xy, int numPoints)
     return PROJ_SUCCESS;
 }
 
+
+// For separate arrays of x and y: the same kernels, reading the
+// arrays directly, with the last few points left to ProjectionBase.
+int DoubleStereographic::fromLatLong(double *x, double *y, int numPoints)
+{
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = fromLatLongAVX512(PointArrays(x, y), numPoints); break;
+      case SIMD_AVX2: done = fromLatLongAVX2(PointArrays(x, y), numPoints); break;
+      case SIMD_SSE2: done = fromLatLongSSE2(PointArrays(x, y), numPoints); break;
+    }
+#endif
+    return ProjectionBase::fromLatLong(x + done, y + done, numPoints - done);
+}
+
+int DoubleStereographic::toLatLong(double *x, double *y, int numPoints)
+{
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = toLatLongAVX512(PointArrays(x, y), numPoints); break;
+      case SIMD_AVX2: done = toLatLongAVX2(PointArrays(x, y), numPoints); break;
+      case SIMD_SSE2: done = toLatLongSSE2(PointArrays(x, y), numPoints); break;
+    }
+#endif
+    return ProjectionBase::toLatLong(x + done, y + done, numPoints - done);
+}
+
+int DoubleStereographic::fromLatLongFast(double *x, double *y, int numPoints)
+{
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = fastFromLatLongAVX512(PointArrays(x, y), numPoints); break;
+      case SIMD_AVX2: done = fastFromLatLongAVX2(PointArrays(x, y), numPoints); break;
+      case SIMD_SSE2: done = fastFromLatLongSSE2(PointArrays(x, y), numPoints); break;
+    }
+#endif
+    return fromLatLong(x + done, y + done, numPoints - done);
+}
+
+int DoubleStereographic::toLatLongFast(double *x, double *y, int numPoints)
+{
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = fastToLatLongAVX512(PointArrays(x, y), numPoints); break;
+      case SIMD_AVX2: done = fastToLatLongAVX2(PointArrays(x, y), numPoints); break;
+      case SIMD_SSE2: done = fastToLatLongSSE2(PointArrays(x, y), numPoints); break;
+    }
+#endif
+    return toLatLong(x + done, y + done, numPoints - done);
+}
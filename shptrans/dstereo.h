@@ -72,12 +72,39 @@ class DoubleStereographic: public ProjectionBase {
     double sin_slat0;   // sin of origin latitude (frequently used)
     double cos_slat0;   // cos of origin latitude (frequently used)
     
+    double lnc2;          // log of c2
+    double chi0;          // conformal latitude of the origin
+    double psi0;          // and its isometric latitude, atanh(sin chi0)
+    double chiSeries[6];  // geodetic to conformal latitude
+    double latSeries[6];  // conformal to geodetic latitude
+    
     int spheroidChanged();
+    
+    // SIMD kernels (dsvec.h); each does a multiple of its width
+    // of the points, and returns how many.
+    template <class Points> int fromLatLongSSE2(Points pts, int numPoints);
+    template <class Points> int toLatLongSSE2(Points pts, int numPoints);
+    template <class Points> int fromLatLongAVX2(Points pts, int numPoints);
+    template <class Points> int toLatLongAVX2(Points pts, int numPoints);
+    template <class Points> int fromLatLongAVX512(Points pts, int numPoints);
+    template <class Points> int toLatLongAVX512(Points pts, int numPoints);
+    template <class Points> int fastFromLatLongSSE2(Points pts, int numPoints);
+    template <class Points> int fastToLatLongSSE2(Points pts, int numPoints);
+    template <class Points> int fastFromLatLongAVX2(Points pts, int numPoints);
+    template <class Points> int fastToLatLongAVX2(Points pts, int numPoints);
+    template <class Points> int fastFromLatLongAVX512(Points pts, int numPoints);
+    template <class Points> int fastToLatLongAVX512(Points pts, int numPoints);
   
   public:
   
     int fromLatLong( double *xy, int numPoints);
     int toLatLong( double *xy, int numPoints);
+    int fromLatLongFast( double *xy, int numPoints);
+    int toLatLongFast( double *xy, int numPoints);
+    int fromLatLong( double *x, double *y, int numPoints);
+    int toLatLong( double *x, double *y, int numPoints);
+    int fromLatLongFast( double *x, double *y, int numPoints);
+    int toLatLongFast( double *x, double *y, int numPoints);
   
     int setOrigin( double lon, double lat);
     
@@ -47,6 +47,21 @@
 
 #include "gshift.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#endif
 
 /*
  * An optimized object-based replacement for the some of
@@ -70,32 +85,144 @@
 
 bool GridShift::highPrecision = false;
 
+bool GridShift::shareFields = false;
+
+static void release_field(float *field, void *share);
+
+long GridShift::reversePoints = 0;
+long GridShift::reverseIterations = 0;
+int GridShift::reverseMaxIterations = 0;
+double GridShift::reverseMaxError = 0;
+
+double GridShift::tolerance = 0;
+
 int GridShift::open(char *fname, char*fdatum, char*tdatum) {
+    close();
+    gridData = grid_open(fname, fdatum, tdatum);
+    if (!gridData) return GRID_ERROR;
+    
+    fileName = (char*)malloc(strlen(fname) + 1);
+    if (fileName) strcpy(fileName, fname);
+    return GRID_OK;
+}
+
+// Add another GSB file, to be searched after those already open
+// (see grid_attach).  Any derived grid is discarded.
+int GridShift::attach(char *fname) {
+    if (!gridData) return open(fname);
+    
+    gridFileType *other = grid_open(fname, 0, 0);
+    if (!other) return GRID_ERROR;
+    
+    if (grid_attach(gridData, other) != GRID_OK) {
+        grid_close(other);
+        return GRID_ERROR;
+    }
+    
+    release_field(inverseField, inverseShare);
+    inverseField = 0;
+    inverseShare = 0;
+    subgridHint = -1;
+    return GRID_OK;
+}
+
+// Keep the shifts as scaled integers, where that is within
+// maxError arc-seconds (see grid_quantize for counts).  Any 
+// derived grid should be built after this.
+int GridShift::quantize(double maxError, int *counts) {
+    if (!gridData) return GRID_ERROR;
     subgridHint = -1;
+    return grid_quantize(gridData, maxError, counts);
+}
+
+void GridShift::close() {
     grid_close(gridData);
-    gridData = grid_open(fname, fdatum, tdatum);
-    return gridData ? GRID_OK : GRID_ERROR;
+    gridData = 0;
+    subgridHint = -1;
+    
+    free(fileName);
+    fileName = 0;
+    
+    release_field(inverseField, inverseShare);
+    inverseField = 0;
+    inverseShare = 0;
+}
+
+// Convert a bounding box (min lon, min lat, max lon, max lat, in
+// degrees) to grid units, for grid_find_box.  Longitude is positive
+// west in the grid, so min and max trade places.
+static void grid_box(double const *bbox, double *box) {
+    box[0] = bbox[2] * -3600.0;
+    box[1] = bbox[1] *  3600.0;
+    box[2] = bbox[0] * -3600.0;
+    box[3] = bbox[3] *  3600.0;
+}
+
+// Start loading the part of the grid that points in bbox will
+// need (see grid_prefetch).
+void GridShift::prefetch(double const*bbox) {
+    if (!gridData) return;
+    
+    double box[4];
+    grid_box(bbox, box);
+    grid_prefetch(gridData, inverseField, box);
 }
 
-int GridShift::forward(double *xy, int xycount, double const*bbox) {
+int GridShift::findCell(double const *xy, int *cell) {
+    cell[0] = cell[1] = -1;
+    if (!gridData) return GRID_ERROR;
+    
+    double x = (xy[0]) * -3600.0;
+    double y = (xy[1]) *  3600.0;
+    return (grid_cell(gridData, x, y, subgridHint, cell) < 0) ? GRID_ERROR : GRID_OK;
+}
+
+int GridShift::forwardStrided(double *px, double *py, int step, int xycount, double const*bbox) {
     if (!gridData) return GRID_ERROR;
     
     int filen = subgridHint; //-1
     int i;
     int errcode;
     int haserr = 0;
+    
+    // If the points are all in one subgrid (as most records 
+    // are), skip the search for each point.
+    if (bbox) {
+        double box[4];
+        grid_box(bbox, box);
+        
+        if ((filen = grid_find_box(gridData, box)) >= 0) {
+            gridEvalType shift;
+            for (; --xycount >= 0; px+=step, py+=step) {
+                double x = (*px) * -3600.0;
+                double y = (*py) *  3600.0;
+                
+                if (grid_interp(gridData, 0, filen, x, y, &shift) < 0) {
+                    haserr = 1;
+                    continue;
+                }
+                
+                *px = (x + shift.diflon) / -3600.0;
+                *py = (y + shift.diflat) /  3600.0;
+            }
+            
+            subgridHint = filen;
+            return haserr ? GRID_ERROR : GRID_OK;
+        }
+        filen = subgridHint;
+    }
  
-    for (; --xycount >= 0; xy+=2) {
-        double x = (xy[0]) * -3600.0;
-        double y = (xy[1]) *  3600.0;
+    for (; --xycount >= 0; px+=step, py+=step) {
+        double x = (*px) * -3600.0;
+        double y = (*py) *  3600.0;
    
         if ((filen = grid_eval(gridData, x, y, filen)) < 0) {
             haserr = 1; filen = -1; 
             continue;
         }
         
-        xy[0] = (x + gridData->diflon) / -3600.0;
-        xy[1] = (y + gridData->diflat) /  3600.0;
+        *px = (x + gridData->diflon) / -3600.0;
+        *py = (y + gridData->diflat) /  3600.0;
     }
     
     subgridHint = filen;
@@ -103,59 +230,94 @@ int GridShift::forward(double *xy, int xycount, double const*bbox) {
     return haserr ? GRID_ERROR : GRID_OK;
 }
 
-
-
-
-
-
-
-
 /*
  * Perform a reverse adjustment of the point.
  * This is more complicated; it involves figuring out which
  * point would be shifted to *xy if this were a forward
  * transformation.
+ *
+ * With a precomputed inverse (see buildInverse), that is a
+ * single interpolation.  Otherwise it is solved point by point
+ * with Newton's method (see solveReverse): grid_eval also
+ * returns the partials of the bilinear cell, so each step 
+ * solves the 2x2 system
+ *
+ *     (I + J) * delta = p + shift(p) - target
+ *
+ * and we stop as soon as delta is below the tolerance.  The
+ * first step is taken from the target itself, so a point that
+ * stays within one cell normally costs two grid_evals in all.
  */
-int GridShift::reverse(double *xy, int xycount, double const*bbox) {
+int GridShift::reverseStrided(double *px, double *py, int step, int xycount, double const*bbox) {
     if (!gridData) return GRID_ERROR;
  
     int filen = subgridHint; //-1;
+    gridEvalType shift;
+    double box[4];
+    int leaf = -1;
     
-    const int iterations = highPrecision ? 12 : 4;
+    if (bbox) grid_box(bbox, box);
     
-    for (; --xycount >= 0; xy+=2) {
-        double x = (xy[0]) * -3600;
-        double y = (xy[1]) *  3600;
-   
-        if ((filen = grid_eval(gridData, x, y, filen)) < 0) {
-            subgridHint = -1;
-            return GRID_ERROR;
-        }
+    if (inverseField) {
+        // the inverse is evaluated at the points themselves
+        if (bbox) leaf = grid_find_box(gridData, box);
         
-        for (int i=0; i<iterations ; i++) {
-            // subtract the forward shift
-            double xWork = x - gridData->diflon;
-            double yWork = y - gridData->diflat;
-         
-            // what would be the forward shift _there_?
-            // (we are looking for a where the forward shift
-            // would take us back to the input point)
-     
-            // get the grid, which is probably the same as the
-            // previus grid so short-circuit for that
-     
-            if ((filen = grid_eval(gridData, xWork, yWork, filen)) < 0) {
+        for (; --xycount >= 0; px+=step, py+=step) {
+            double x = (*px) * -3600;
+            double y = (*py) *  3600;
+            
+            if (leaf >= 0) {
+                filen = grid_interp(gridData, inverseField, leaf, x, y, &shift);
+            } else {
+                filen = grid_eval_r(gridData, inverseField, x, y, filen, &shift);
+            }
+            if (filen < 0) {
                 subgridHint = -1;
                 return GRID_ERROR;
             }
             
-            // we could short-circuit if the deltas get really small, but
-            // those final iterations will be fast anyway, thanks to the
-            // subgrid hint optimization.
+            *px = (x + shift.diflon) / -3600;
+            *py = (y + shift.diflat) /  3600;
+        }
+        
+        subgridHint = filen;
+        return GRID_OK;
+    }
+    
+    if (bbox) {
+        // The solver also evaluates the grid where the points came
+        // from, about one shift away; widen the box to cover that,
+        // judging by the shift in the middle, plus some margin.
+        // Any step that still lands outside is searched for as usual.
+        if (grid_eval_r(gridData, 0, (box[0] + box[2]) / 2, (box[1] + box[3]) / 2, filen, &shift) >= 0) {
+            double mx = fabs(shift.diflon) * 0.1 + 0.01;
+            double my = fabs(shift.diflat) * 0.1 + 0.01;
+            if (shift.diflon > 0) box[0] -= shift.diflon; else box[2] -= shift.diflon;
+            if (shift.diflat > 0) box[1] -= shift.diflat; else box[3] -= shift.diflat;
+            box[0] -= mx; box[2] += mx;
+            box[1] -= my; box[3] += my;
+            leaf = grid_find_box(gridData, box);
+        }
+    }
+    
+    for (; --xycount >= 0; px+=step, py+=step) {
+        double x = (*px) * -3600;
+        double y = (*py) *  3600;
+        int iter;
+        double err;
+   
+        if (solveReverse(x, y, filen, iter, leaf, box, &err) != GRID_OK) {
+            subgridHint = -1;
+            return GRID_ERROR;
         }
+        
+        ++reversePoints;
+        reverseIterations += iter;
+        if (iter > reverseMaxIterations) reverseMaxIterations = iter;
+        if (err > reverseMaxError) reverseMaxError = err;
    
-        xy[0] = (x - gridData->diflon) / -3600;
-        xy[1] = (y - gridData->diflat) /  3600;
+        *px = x / -3600;
+        *py = y /  3600;
     }
     
     subgridHint = filen;
@@ -163,6 +325,856 @@ int GridShift::reverse(double *xy, int xycount, double const*bbox) {
 }
 
 
+// Evaluate the grid at x,y: directly in subgrid leaf if x,y is
+// in box (see grid_find_box), or else by searching from the hint.
+#define EVAL_SHIFT(X, Y) ( \
+    ((leaf >= 0) && ((X) >= box[0]) && ((X) <= box[2]) && ((Y) >= box[1]) && ((Y) <= box[3])) \
+      ? grid_interp(gridData, 0, leaf, X, Y, &shift) \
+      : grid_eval_r(gridData, 0, X, Y, filen, &shift) )
+
+/*
+ * Newton solver for one point of a reverse shift.  x,y are
+ * in arc-seconds (positive west), and are replaced by the
+ * solution.  filen is the subgrid hint, and is updated.
+ * If error is given, it receives a bound on the error left,
+ * in arc-seconds.  This only uses grid_eval_r, so it is safe to call from
+ * the threads in buildInverse, once the grid is read in (grid_load).
+ */
+int GridShift::solveReverse(double &x, double &y, int &filen, int &iter, int leaf, double const *box, double *error) {
+    // Tolerance is in arc-seconds: 1e-6" is about 0.03mm.
+    const double stepmax = highPrecision ? 1E-9 : 1E-6;
+    const int maxiter = (highPrecision || tolerance > 0) ? 12 : 4;
+    
+    gridEvalType shift;
+    
+    if ((filen = EVAL_SHIFT(x, y)) < 0) {
+        return GRID_ERROR;
+    }
+    
+    double xWork = x;
+    double yWork = y;
+    iter = 0;
+    
+    while (1) {
+        // residual: how far the forward shift of the current
+        // estimate lands from the input point
+        double rx = xWork + shift.diflon - x;
+        double ry = yWork + shift.diflat - y;
+        
+        double jxx = 1 + shift.dlondx, jxy = shift.dlondy;
+        double jyx = shift.dlatdx,     jyy = 1 + shift.dlatdy;
+        double det = jxx*jyy - jxy*jyx;
+        
+        double dx = (rx*jyy - ry*jxy) / det;
+        double dy = (ry*jxx - rx*jyx) / det;
+        
+        xWork -= dx;
+        yWork -= dy;
+        
+        // The error left after the step is about the step times the
+        // change in the Jacobian along it, which is at most twice the
+        // shift's derivatives (a few parts per million, in these grids);
+        // twice that again is a safe bound.  With a -tolerance, stop as
+        // soon as that is within it; otherwise wait for the step itself
+        // to fall below the fixed threshold.
+        double slope = fabs(jxx - 1) + fabs(jxy);
+        if (fabs(jyx) + fabs(jyy - 1) > slope) slope = fabs(jyx) + fabs(jyy - 1);
+        double err = 4 * slope * (fabs(dx) > fabs(dy) ? fabs(dx) : fabs(dy));
+        if (error) *error = err;
+        
+        if ((++iter >= maxiter) || ((tolerance > 0) 
+              ? (err < tolerance) 
+              : (fabs(dx) < stepmax && fabs(dy) < stepmax))) {
+            break;
+        }
+        
+        // what would be the forward shift _there_?  It is
+        // probably in the same subgrid, so use it as the hint.
+        if ((filen = EVAL_SHIFT(xWork, yWork)) < 0) {
+            return GRID_ERROR;
+        }
+    }
+    
+    x = xWork;
+    y = yWork;
+    return GRID_OK;
+}
+
+#undef EVAL_SHIFT
+
+
+
+
+/*
+ * Derived grids.
+ *
+ * A derived grid has the same subgrids and nodes as a GSB file,
+ * but holds different shifts: a lat,lon pair of floats for each
+ * record (see grid_alloc_field).  FieldBuilder fills one in by 
+ * asking a subclass for the exact shift at every node, then checks
+ * the result at the centre of every cell, where interpolation error 
+ * is largest.  Both passes are split by rows among one thread per 
+ * processor.
+ */
+
+#define MAX_BUILD_THREADS 32
+
+#ifdef _WIN32
+# define NEXT_INDEX(counter) (InterlockedIncrement(&(counter)) - 1)
+#else
+# define NEXT_INDEX(counter) __sync_fetch_and_add(&(counter), 1)
+#endif
+
+struct FieldBuilder {
+    gridFileType *lattice;
+    float *field;
+    
+    long volatile nextRow;
+    long volatile nextThread;
+    long totalRows;
+    int validating;
+    double maxError[MAX_BUILD_THREADS];
+    
+    FieldBuilder(gridFileType *grid, float *f): lattice(grid), field(f) {}
+    virtual ~FieldBuilder() {}
+    
+    // The exact shift (arc-seconds) at x,y.  hint is a pair of
+    // subgrid hints, for whatever grids are involved, which is
+    // kept from one call to the next by each thread.
+    virtual int exact(double x, double y, int *hint, double *dlon, double *dlat) = 0;
+    
+    // Read in every grid that exact evaluates, so that the threads
+    // don't race to load subgrids (see grid_load).
+    virtual int load() = 0;
+    
+    double build();
+    void work();
+    
+#ifdef _WIN32
+    static DWORD WINAPI threadFunc(void *arg) {
+        ((FieldBuilder*)arg)->work();
+        return 0;
+    }
+#else
+    static void *threadFunc(void *arg) {
+        ((FieldBuilder*)arg)->work();
+        return 0;
+    }
+#endif
+};
+
+
+void FieldBuilder::work() {
+    int thread = NEXT_INDEX(nextThread);
+    int hint[2] = { -1, -1 };
+    double maxErr = 0;
+    gridEvalType shift;
+    long row;
+    
+    while ((row = NEXT_INDEX(nextRow)) < totalRows) {
+        subGridType *subgrid = lattice->subGrid;
+        while (row >= subgrid->nrows) {
+            row -= subgrid->nrows;
+            ++subgrid;
+        }
+        
+        double lat = subgrid->alimit[0] + row * subgrid->alimit[4];
+        int filen = subgrid - lattice->subGrid;
+        
+        if (!validating) {
+            float *node = field + 2 * (subgrid->fstart - 1 + row * subgrid->ncols);
+            for (int col = 0; col < subgrid->ncols; ++col, node += 2) {
+                double lon = subgrid->alimit[2] + col * subgrid->alimit[5];
+                double dlon, dlat;
+                
+                if (exact(lon, lat, hint, &dlon, &dlat) == GRID_OK) {
+                    node[0] = (float)dlat;
+                    node[1] = (float)dlon;
+                } else {
+                    // not defined here; lookups that touch this node
+                    // will come out as NaN.
+                    node[0] = node[1] = (float)sqrt(-1.0);
+                }
+            }
+        } else if (row < subgrid->nrows - 1) {
+            lat += subgrid->alimit[4] / 2;
+            for (int col = 0; col < subgrid->ncols - 1; ++col) {
+                double lon = subgrid->alimit[2] + (col + 0.5) * subgrid->alimit[5];
+                double dlon, dlat;
+                
+                if (exact(lon, lat, hint, &dlon, &dlat) != GRID_OK) continue;
+                if (grid_eval_r(lattice, field, lon, lat, filen, &shift) < 0) continue;
+                
+                double err = fabs(shift.diflon - dlon);
+                if (fabs(shift.diflat - dlat) > err) err = fabs(shift.diflat - dlat);
+                if (err > maxErr) maxErr = err;  // (false for NaN)
+            }
+        }
+    }
+    
+    if (thread < MAX_BUILD_THREADS) maxError[thread] = maxErr;
+}
+
+
+// Fill in the field, then validate it.  Returns the largest 
+// discrepancy found, in arc-seconds.
+double FieldBuilder::build() {
+    int nthreads = 1;
+    int i;
+    
+    totalRows = 0;
+    for (i = 0; i < lattice->nfiles; ++i) {
+        totalRows += lattice->subGrid[i].nrows;
+    }
+    
+#ifdef _WIN32
+    SYSTEM_INFO sysInfo;
+    GetSystemInfo(&sysInfo);
+    nthreads = sysInfo.dwNumberOfProcessors;
+#else
+    nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > MAX_BUILD_THREADS) nthreads = MAX_BUILD_THREADS;
+    
+    // If the grids can't all be read in, the subgrids are loaded as
+    // they are reached, which only one thread may do.
+    if (load() != GRID_OK) nthreads = 1;
+    
+    for (validating = 0; validating < 2; ++validating) {
+        nextRow = 0;
+        nextThread = 0;
+        for (i = 0; i < MAX_BUILD_THREADS; ++i) maxError[i] = 0;
+        
+#ifdef _WIN32
+        HANDLE threads[MAX_BUILD_THREADS];
+        int nstarted = 0;
+        DWORD threadId;
+        
+        for (i = 1; i < nthreads; ++i) {
+            threads[nstarted] = CreateThread(NULL, 0, threadFunc, this, 0, &threadId);
+            if (threads[nstarted]) ++nstarted;
+        }
+        
+        work();
+        
+        if (nstarted) {
+            WaitForMultipleObjects(nstarted, threads, TRUE, INFINITE);
+            for (i = 0; i < nstarted; ++i) CloseHandle(threads[i]);
+        }
+#else
+        pthread_t threads[MAX_BUILD_THREADS];
+        int nstarted = 0;
+        
+        for (i = 1; i < nthreads; ++i) {
+            if (pthread_create(&threads[nstarted], NULL, threadFunc, this) == 0) ++nstarted;
+        }
+        
+        work();
+        
+        for (i = 0; i < nstarted; ++i) pthread_join(threads[i], NULL);
+#endif
+    }
+    
+    double maxErr = 0;
+    for (i = 0; i < MAX_BUILD_THREADS; ++i) {
+        if (maxError[i] > maxErr) maxErr = maxError[i];
+    }
+    return maxErr;
+}
+
+
+
+/*
+ * Derived grids can take a while to build for a large GSB, so
+ * they may be cached in a file.  The file starts with a key that
+ * describes the grids the field was built from; if that does not
+ * match, the cache is not used (and will be overwritten).
+ */
+
+static const char fieldMagic[8] = { 'S','H','P','T','F','L','D','1' };
+
+static int load_field(
+    char const *fname, double const *key, int nkey,
+    float *field, long nfloats, double *error
+) {
+    FILE *f = fopen(fname, "rb");
+    if (!f) return GRID_ERROR;
+    
+    char magic[8];
+    int fileNkey = 0;
+    long fileNfloats = 0;
+    int ok = (
+        (fread(magic, 1, 8, f) == 8) && (0 == memcmp(magic, fieldMagic, 8))
+     && (fread(&fileNkey, sizeof(int), 1, f) == 1) && (fileNkey == nkey)
+     && (fread(&fileNfloats, sizeof(long), 1, f) == 1) && (fileNfloats == nfloats)
+     && (fread(error, sizeof(double), 1, f) == 1)
+    );
+    
+    for (int i = 0; ok && i < nkey; ++i) {
+        double k;
+        ok = (fread(&k, sizeof(double), 1, f) == 1) && (k == key[i]);
+    }
+    
+    ok = ok && (fread(field, sizeof(float), nfloats, f) == (size_t)nfloats);
+    
+    fclose(f);
+    return ok ? GRID_OK : GRID_ERROR;
+}
+
+static void save_field(
+    char const *fname, double const *key, int nkey,
+    float const *field, long nfloats, double error
+) {
+    FILE *f = fopen(fname, "wb");
+    if (!f) return;  // the cache is optional
+    
+    int ok = (
+        (fwrite(fieldMagic, 1, 8, f) == 8)
+     && (fwrite(&nkey, sizeof(int), 1, f) == 1)
+     && (fwrite(&nfloats, sizeof(long), 1, f) == 1)
+     && (fwrite(&error, sizeof(double), 1, f) == 1)
+     && (fwrite(key, sizeof(double), nkey, f) == (size_t)nkey)
+     && (fwrite(field, sizeof(float), nfloats, f) == (size_t)nfloats)
+    );
+    
+    fclose(f);
+    if (!ok) remove(fname);
+}
+
+// Describe a grid's layout for the cache key: the record count,
+// the quantization error bound and every subgrid's limits.
+// Returns the number of doubles written to key (if key is NULL,
+// just counts them).
+static int grid_key(gridFileType *grid, double *key) {
+    int n = 0;
+    if (key) {
+        key[0] = grid->nRecs;
+        key[1] = grid->nfiles;
+        key[2] = grid->subGrid[0].qbound;
+    }
+    n += 3;
+    for (int i = 0; i < grid->nfiles; ++i) {
+        for (int j = 0; j < 6; ++j, ++n) {
+            if (key) key[n] = grid->subGrid[i].alimit[j];
+        }
+    }
+    return n;
+}
+
+// The size and modification time of each file of a grid, so that
+// a file replaced by a newer version with the same layout doesn't
+// match.  These go at the end of the key (see share_field).
+static int file_key(gridFileType *grid, double *key) {
+    int n = 0;
+    for (gridFileType *file = grid; file; file = file->next, n += 2) {
+        if (key) {
+            key[n] = file->fsize;
+            key[n+1] = file->fmtime;
+        }
+    }
+    return n;
+}
+
+
+
+
+/*
+ * With GridShift::shareFields, derived grids are also shared 
+ * between processes.  The first process to need one publishes it
+ * in a named shared memory section, and others running at the same
+ * time (or, on POSIX systems, later) map the same pages, read-only,
+ * instead of loading or building it again.  Only the derived grids
+ * are shared: each process still reads the GSB headers itself, and
+ * keeps its own node data (except on Win32, where the GSB file is
+ * mapped) and its own -quantgrid copy.
+ *
+ * The section is named for a hash of the key, less the files' sizes
+ * and times at the end of it, and holds the whole key to rule out
+ * collisions.  So when a GSB file changes, the next process finds
+ * the old grid under the same name; on POSIX, where a section 
+ * outlives the processes using it, it unlinks that and publishes a
+ * new one.  (On Win32 a section goes away with the last process 
+ * using it.)  Otherwise POSIX sections stay until the system is 
+ * restarted; they are /shptrans-* in shm_open's namespace, which 
+ * is /dev/shm on Linux, and can be removed there at any time.
+ *
+ * A process holds a lock on the section while it fills it in, so
+ * others wait rather than building the same grid; if it dies 
+ * first, the next one to get the lock finds it unfilled and
+ * fills it in.  Only that process maps the section writable, and
+ * only until it is published.
+ */
+
+struct SharedField {
+    char magic[8];
+    int ready;      // set once the field is filled in
+    int nkey;
+    long nfloats;
+    double error;
+    // followed by nkey doubles (the key), then the field
+};
+
+struct FieldShare {
+#ifdef _WIN32
+    HANDLE hMap;
+    HANDLE hLock;
+#else
+    int fd;
+#endif
+    SharedField *view;
+    size_t size;
+};
+
+#define SHARED_KEY(view) ((double*)((char*)(view) + ((sizeof(SharedField) + 7) & ~7)))
+
+static unsigned long key_hash(double const *key, int nkey, unsigned long h) {
+    unsigned char const *p = (unsigned char const*)key;
+    for (size_t i = 0; i < nkey * sizeof(double); ++i) {
+        h = ((h ^ p[i]) * 16777619UL) & 0xFFFFFFFFUL;  // FNV-1a
+    }
+    return h;
+}
+
+static void unlock_share(FieldShare *share) {
+#ifdef _WIN32
+    ReleaseMutex(share->hLock);
+#else
+    flock(share->fd, LOCK_UN);
+#endif
+}
+
+static void unmap_share(FieldShare *share) {
+#ifdef _WIN32
+    if (share->view) UnmapViewOfFile(share->view);
+#else
+    if (share->view) munmap(share->view, share->size);
+#endif
+    share->view = 0;
+}
+
+// Map the section read-only, or writable to fill it in.
+static void map_share(FieldShare *share, int writable) {
+#ifdef _WIN32
+    share->view = (SharedField*)MapViewOfFile(
+        share->hMap, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, share->size
+    );
+#else
+    share->view = (SharedField*)mmap(
+        0, share->size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, share->fd, 0
+    );
+    if (share->view == MAP_FAILED) share->view = 0;
+#endif
+}
+
+static void release_share(FieldShare *share) {
+    unmap_share(share);
+#ifdef _WIN32
+    if (share->hMap) CloseHandle(share->hMap);
+    if (share->hLock) CloseHandle(share->hLock);
+#else
+    if (share->fd >= 0) close(share->fd);
+#endif
+    free(share);
+}
+
+/*
+ * Map the shared section for a derived grid.  The first nname
+ * doubles of the key name the section; the rest identify the 
+ * files it was built from.  Returns the field, or NULL if it 
+ * can't be shared (the caller then uses a private copy).  If
+ * *filled is set, another process has filled it in, and its error
+ * is in *error; the field is read-only.  Otherwise the caller must
+ * fill it in and call publish_field, which also releases the lock.
+ */
+static float *share_field(
+    double const *key, int nkey, int nname, long nfloats,
+    void **shareOut, int *filled, double *error
+) {
+    char name[64];
+    size_t keyOffset = (char*)SHARED_KEY(0) - (char*)0;
+    size_t size = keyOffset + nkey * sizeof(double) + nfloats * sizeof(float);
+    
+    *shareOut = 0;
+    *filled = 0;
+    
+    FieldShare *share = (FieldShare*)calloc(1, sizeof(FieldShare));
+    if (!share) return NULL;
+    share->size = size;
+    
+#ifdef _WIN32
+    sprintf(name, "SHPTRANS-%08lX%08lX-LOCK", key_hash(key, nname, 2166136261UL), key_hash(key, nname, 84696351UL));
+    share->hLock = CreateMutex(NULL, FALSE, name);
+    if (!share->hLock) { release_share(share); return NULL; }
+    
+    DWORD wait = WaitForSingleObject(share->hLock, INFINITE);
+    if ((wait != WAIT_OBJECT_0) && (wait != WAIT_ABANDONED)) { release_share(share); return NULL; }
+    
+    name[strlen(name) - 5] = '\0';  // the section itself
+    share->hMap = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)size, name);
+    if (share->hMap) map_share(share, 0);
+#else
+    sprintf(name, "/shptrans-%08lx%08lx", key_hash(key, nname, 2166136261UL), key_hash(key, nname, 84696351UL));
+    
+    for (int attempt = 0; ; ++attempt) {
+        share->fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+        if (share->fd < 0) { release_share(share); return NULL; }
+        
+        if (flock(share->fd, LOCK_EX) != 0) { release_share(share); return NULL; }
+        
+        struct stat st;
+        if (fstat(share->fd, &st) != 0) { unlock_share(share); release_share(share); return NULL; }
+        
+        if (st.st_size == 0) {
+            // new; fill it in below
+            if (ftruncate(share->fd, size) != 0) { unlock_share(share); release_share(share); return NULL; }
+            map_share(share, 0);
+            break;
+        }
+        
+        if ((size_t)st.st_size == size) map_share(share, 0);
+        
+        // anything else under this name was built from files that
+        // have changed since (or is a collision); replace it, once.
+        SharedField *view = share->view;
+        if (view && !(
+            memcmp(view->magic, fieldMagic, 8) || (view->nkey != nkey) || (view->nfloats != nfloats)
+         || memcmp(SHARED_KEY(view), key, nkey * sizeof(double))
+        )) {
+            break;
+        }
+        
+        unmap_share(share);
+        if (attempt || shm_unlink(name) != 0) { unlock_share(share); release_share(share); return NULL; }
+        unlock_share(share);
+        close(share->fd);
+    }
+#endif
+    
+    SharedField *view = share->view;
+    if (!view) {
+        unlock_share(share);
+        release_share(share);
+        return NULL;
+    }
+    
+    if (view->ready) {
+        // filled in already; make sure it is the same grid
+        if (
+            memcmp(view->magic, fieldMagic, 8) || (view->nkey != nkey) || (view->nfloats != nfloats)
+         || memcmp(SHARED_KEY(view), key, nkey * sizeof(double))
+        ) {
+            unlock_share(share);
+            release_share(share);
+            return NULL;
+        }
+        *error = view->error;
+        *filled = 1;
+        unlock_share(share);
+    } else {
+        // this process fills it in
+        unmap_share(share);
+        map_share(share, 1);
+        view = share->view;
+        if (!view) {
+            unlock_share(share);
+            release_share(share);
+            return NULL;
+        }
+        memcpy(view->magic, fieldMagic, 8);
+        view->nkey = nkey;
+        view->nfloats = nfloats;
+        memcpy(SHARED_KEY(view), key, nkey * sizeof(double));
+    }
+    
+    *shareOut = share;
+    return (float*)(SHARED_KEY(view) + nkey);
+}
+
+// Mark the field filled in, release the lock, and give up write
+// access to it.
+static void publish_field(void *shareIn, double error) {
+    FieldShare *share = (FieldShare*)shareIn;
+    share->view->error = error;
+    share->view->ready = 1;
+    unlock_share(share);
+    
+#ifdef _WIN32
+    DWORD oldProtect;
+    VirtualProtect(share->view, share->size, PAGE_READONLY, &oldProtect);
+#else
+    mprotect(share->view, share->size, PROT_READ);
+#endif
+}
+
+// Release a derived grid, whether shared or private.
+static void release_field(float *field, void *share) {
+    if (share) {
+        release_share((FieldShare*)share);
+    } else {
+        free(field);
+    }
+}
+
+// Get the memory for a derived grid: shared if possible, and 
+// otherwise private.  Returns 1 if it is already filled in.
+static int alloc_field(
+    gridFileType *lattice, double const *key, int nkey, int nname,
+    float **field, void **share, double *error
+) {
+    int filled = 0;
+    *field = 0;
+    *share = 0;
+    
+    if (GridShift::shareFields) {
+        *field = share_field(key, nkey, nname, 2L * lattice->nRecs, share, &filled, error);
+    }
+    if (!*field) {
+        *field = grid_alloc_field(lattice);
+    }
+    return filled;
+}
+
+
+
+
+/*
+ * The inverse grid: at each node q, the shift that takes q back
+ * to the point p for which the forward shift gives q.  Where the
+ * solver fails (near the edge of the grid, p may be outside it),
+ * the negated forward shift at q is used instead.
+ */
+struct InverseBuilder: public FieldBuilder {
+    GridShift *gs;
+    
+    InverseBuilder(GridShift *g, float *f): FieldBuilder(g->gridData, f), gs(g) {}
+    
+    int load() { return grid_load(gs->gridData); }
+    
+    int exact(double x, double y, int *hint, double *dlon, double *dlat) {
+        double xWork = x, yWork = y;
+        int iter;
+        
+        if (gs->solveReverse(xWork, yWork, hint[0], iter) == GRID_OK) {
+            *dlon = xWork - x;
+            *dlat = yWork - y;
+            return GRID_OK;
+        }
+        
+        gridEvalType shift;
+        if (grid_eval_r(lattice, 0, x, y, -1, &shift) < 0) return GRID_ERROR;
+        *dlon = -shift.diflon;
+        *dlat = -shift.diflat;
+        return GRID_OK;
+    }
+};
+
+
+int GridShift::buildInverse(char const *cacheFile) {
+    if (!gridData) return GRID_ERROR;
+    
+    release_field(inverseField, inverseShare);
+    inverseField = 0;
+    inverseShare = 0;
+    
+    long nfloats = 2L * gridData->nRecs;
+    int nname = grid_key(gridData, 0) + 2;
+    int nkey = nname + file_key(gridData, 0);
+    double *key = (double*)malloc(nkey * sizeof(double));
+    if (!key) return GRID_ERROR;
+    
+    key[0] = 1; // identifies the kind of derived grid: an inverse
+    key[1] = (tolerance > 0) ? -tolerance : highPrecision; // solver settings
+    grid_key(gridData, key + 2);
+    file_key(gridData, key + nname);
+    
+    int filled = alloc_field(gridData, key, nkey, nname, &inverseField, &inverseShare, &inverseError);
+    if (!inverseField) {
+        free(key);
+        return GRID_ERROR;
+    }
+    
+    if (!filled) {
+        if (!cacheFile || GRID_OK != load_field(cacheFile, key, nkey, inverseField, nfloats, &inverseError)) {
+            InverseBuilder builder(this, inverseField);
+            inverseError = builder.build();
+            if (cacheFile) save_field(cacheFile, key, nkey, inverseField, nfloats, inverseError);
+        }
+        if (inverseShare) publish_field(inverseShare, inverseError);
+    }
+    
+    free(key);
+    return GRID_OK;
+}
+
+
+
+/*
+ * The composed grid, for a forward shift followed by a reverse
+ * shift through a common datum (NAD27 -> NAD83 -> ATS77, or the 
+ * other way).  Where the two grids don't overlap, the nodes are
+ * NaN and apply() falls back to the two steps.
+ */
+struct ChainBuilder: public FieldBuilder {
+    GridShift *first, *second;
+    
+    ChainBuilder(GridShift *f, GridShift *s, GridShift *l, float *field):
+        FieldBuilder(l->gridData, field), first(f), second(s) {}
+    
+    int load() {
+        return (grid_load(first->gridData) == GRID_OK && grid_load(second->gridData) == GRID_OK)
+            ? GRID_OK : GRID_ERROR;
+    }
+    
+    int exact(double x, double y, int *hint, double *dlon, double *dlat) {
+        gridEvalType shift;
+        int iter;
+        
+        if ((hint[0] = grid_eval_r(first->gridData, 0, x, y, hint[0], &shift)) < 0) {
+            return GRID_ERROR;
+        }
+        
+        double xWork = x + shift.diflon;
+        double yWork = y + shift.diflat;
+        
+        if (second->solveReverse(xWork, yWork, hint[1], iter) != GRID_OK) {
+            hint[1] = -1;
+            return GRID_ERROR;
+        }
+        
+        *dlon = xWork - x;
+        *dlat = yWork - y;
+        return GRID_OK;
+    }
+};
+
+
+int ChainedShift::build(GridShift &f, GridShift &s, GridShift &lattice, char const *cacheFile) {
+    close();
+    latticeGrid = lattice.gridData;
+    hint = -1;
+    
+    if (!f.gridData || !s.gridData || !latticeGrid) return GRID_ERROR;
+    
+    long nfloats = 2L * latticeGrid->nRecs;
+    int nname = grid_key(f.gridData, 0) + grid_key(s.gridData, 0) + 3;
+    int nkey = nname + file_key(f.gridData, 0) + file_key(s.gridData, 0);
+    double *key = (double*)malloc(nkey * sizeof(double));
+    if (!key) return GRID_ERROR;
+    
+    key[0] = 2; // identifies the kind of derived grid: a chain
+    key[1] = (GridShift::tolerance > 0) ? -GridShift::tolerance : GridShift::highPrecision;
+    key[2] = (&lattice == &f);
+    grid_key(s.gridData, key + 3 + grid_key(f.gridData, key + 3));
+    file_key(s.gridData, key + nname + file_key(f.gridData, key + nname));
+    
+    int filled = alloc_field(latticeGrid, key, nkey, nname, &field, &share, &error);
+    if (!field) {
+        free(key);
+        return GRID_ERROR;
+    }
+    
+    if (!filled) {
+        if (!cacheFile || GRID_OK != load_field(cacheFile, key, nkey, field, nfloats, &error)) {
+            ChainBuilder builder(&f, &s, &lattice, field);
+            error = builder.build();
+            if (cacheFile) save_field(cacheFile, key, nkey, field, nfloats, error);
+        }
+        if (share) publish_field(share, error);
+    }
+    
+    free(key);
+    first = &f;
+    second = &s;
+    return GRID_OK;
+}
+
+
+void ChainedShift::prefetch(double const*bbox) {
+    if (!field) return;
+    
+    double box[4];
+    grid_box(bbox, box);
+    grid_prefetch(latticeGrid, field, box);
+}
+
+
+void ChainedShift::close() {
+    release_field(field, share);
+    field = 0;
+    share = 0;
+    first = second = 0;
+    latticeGrid = 0;
+}
+
+
+/*
+ * One interpolation per point.  Points outside the composed grid,
+ * or where it is undefined, are shifted in two steps as before.
+ */
+int ChainedShift::findCell(double const *xy, int *cell) {
+    cell[0] = cell[1] = -1;
+    if (!field) return GRID_ERROR;
+    
+    double x = (xy[0]) * -3600.0;
+    double y = (xy[1]) *  3600.0;
+    gridEvalType shift;
+    int filen = grid_cell(latticeGrid, x, y, hint, cell);
+    
+    // (NaN compares unequal to itself)
+    if ((filen < 0) || (grid_interp(latticeGrid, field, filen, x, y, &shift) < 0)
+      || (shift.diflon != shift.diflon) || (shift.diflat != shift.diflat)) {
+        cell[0] = cell[1] = -1;
+        return GRID_ERROR;
+    }
+    return GRID_OK;
+}
+
+int ChainedShift::applyStrided(double *px, double *py, int step, int xycount, double const*bbox) {
+    if (!field) return GRID_ERROR;
+    
+    int filen = hint;
+    int haserr = 0;
+    gridEvalType shift;
+    int leaf = -1;
+    
+    if (bbox) {
+        double box[4];
+        grid_box(bbox, box);
+        leaf = grid_find_box(latticeGrid, box);
+    }
+    
+    for (; --xycount >= 0; px+=step, py+=step) {
+        double x = (*px) * -3600.0;
+        double y = (*py) *  3600.0;
+        
+        if (leaf >= 0) {
+            filen = grid_interp(latticeGrid, field, leaf, x, y, &shift);
+        } else {
+            filen = grid_eval_r(latticeGrid, field, x, y, filen, &shift);
+        }
+        
+        // (NaN compares unequal to itself)
+        if ((filen < 0) || (shift.diflon != shift.diflon) || (shift.diflat != shift.diflat)) {
+            filen = -1;
+            double xy[2] = { *px, *py };
+            if (first->forward(xy, 1) || second->reverse(xy, 1)) {
+                haserr = 1;
+            }
+            *px = xy[0];
+            *py = xy[1];
+            continue;
+        }
+        
+        *px = (x + shift.diflon) / -3600.0;
+        *py = (y + shift.diflat) /  3600.0;
+    }
+    
+    hint = filen;
+    return haserr ? GRID_ERROR : GRID_OK;
+}
+
+
 
 /**
  * NTv2 Support:
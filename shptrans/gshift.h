@@ -56,17 +56,28 @@ class GridShift {
       apply_forward,apply_reverse
     };
   
-    GridShift():gridData(0) {}
+    GridShift():gridData(0),subgridHint(-1),fileName(0),inverseField(0),inverseShare(0) {}
     GridShift(char *fname, char*fdatum=0, char*tdatum=0):
-        gridData(grid_open(fname, fdatum, tdatum)) {}
+        gridData(0),subgridHint(-1),fileName(0),inverseField(0),inverseShare(0) { open(fname, fdatum, tdatum); }
   
-    ~GridShift() { grid_close(gridData); }
+    ~GridShift() { close(); }
   
     int open(char *fname, char*fdatum=0, char*tdatum=0);
-    void close() { grid_close(gridData); gridData=0; }
+    int attach(char *fname);
+    int quantize(double maxError, int *counts = 0);
+    void close();
   
-    int forward(double *xy, int count, double const*bbox=0);
-    int reverse(double *xy, int count, double const*bbox=0);
+    int forward(double *xy, int count, double const*bbox=0) { return forwardStrided(xy, xy+1, 2, count, bbox); }
+    int reverse(double *xy, int count, double const*bbox=0) { return reverseStrided(xy, xy+1, 2, count, bbox); }
+    
+    // the same, for separate arrays of x and y
+    int forward(double *x, double *y, int count, double const*bbox=0) { return forwardStrided(x, y, 1, count, bbox); }
+    int reverse(double *x, double *y, int count, double const*bbox=0) { return reverseStrided(x, y, 1, count, bbox); }
+    void prefetch(double const*bbox);
+    
+    // The cell of the grid that the lon,lat point xy is interpolated
+    // in (see grid_cell), or GRID_ERROR (and -1,-1) if off the grid.
+    int findCell(double const *xy, int *cell);
   
     int apply(direction d, double *xy, int count, double const*bbox=0) {
         return (d==apply_forward)
@@ -74,17 +85,98 @@ class GridShift {
           : reverse(xy,count,bbox);
     }
     
+    // Precompute the inverse of the shift field, so that reverse()
+    // is a single interpolation.  If cacheFile is given, the inverse
+    // is loaded from there if it matches this grid, or saved there
+    // once built.  The largest difference from the iterative solver,
+    // in arc-seconds, is available from getInverseError().
+    int buildInverse(char const *cacheFile = 0);
+    double getInverseError() const { return inverseError; }
+    
+    char const *getFileName() const { return fileName; }
+    
     static bool highPrecision;
+    
+    // Where reverse() stops, as the error left in arc-seconds; 0 for
+    // the fixed defaults (see highPrecision).
+    static double tolerance;
+    
+    // share derived grids with other processes (see share_field)
+    static bool shareFields;
+    
+    // reverse solver statistics, for -verbose
+    static long reversePoints;      // points solved by reverse()
+    static long reverseIterations;  // Newton steps taken, in total
+    static int reverseMaxIterations;// most Newton steps for any point
+    static double reverseMaxError;  // largest error left, in arc-seconds
   
   protected:
     gridFileType *gridData;
     int subgridHint;
+    char *fileName;
+    
+    float *inverseField;   // lat,lon per record; see grid_alloc_field
+    void *inverseShare;    // if inverseField is shared memory
+    double inverseError;
+    
+    // the points are px[0],py[0], px[step],py[step], ...
+    int forwardStrided(double *px, double *py, int step, int count, double const*bbox);
+    int reverseStrided(double *px, double *py, int step, int count, double const*bbox);
+    
+    int solveReverse(double &x, double &y, int &filen, int &iter, int leaf = -1, double const *box = 0, double *error = 0);
+    
+    friend struct InverseBuilder;
+    friend struct ChainBuilder;
+    friend class ChainedShift;
   
   private:
     GridShift(GridShift&);
     void operator=(GridShift&);
 };
 
+
+
+// A forward shift by one grid followed by a reverse shift by another,
+// composed into a single derived grid, on the nodes of a third (which
+// should be whichever of the two is finer).  Builds, or loads from
+// cacheFile, like GridShift::buildInverse.
+class ChainedShift {
+  public:
+    ChainedShift(): first(0), second(0), latticeGrid(0), field(0), share(0), error(0), hint(-1) {}
+    ~ChainedShift() { close(); }
+    
+    int build(GridShift &first, GridShift &second, GridShift &lattice, char const *cacheFile = 0);
+    void close();
+    bool ready() const { return field != 0; }
+    
+    int apply(double *xy, int count, double const*bbox=0) { return applyStrided(xy, xy+1, 2, count, bbox); }
+    int apply(double *x, double *y, int count, double const*bbox=0) { return applyStrided(x, y, 1, count, bbox); }
+    void prefetch(double const*bbox);
+    
+    // As GridShift::findCell, in the composed grid; a cell where it
+    // has no value (and apply falls back on the two grids) counts as
+    // off the grid.
+    int findCell(double const *xy, int *cell);
+    
+    // largest difference from the two-step shift, in arc-seconds
+    double getError() const { return error; }
+  
+  protected:
+    GridShift *first;
+    GridShift *second;
+    gridFileType *latticeGrid;
+    float *field;
+    void *share;
+    double error;
+    int hint;
+    
+    int applyStrided(double *px, double *py, int step, int count, double const*bbox);
+  
+  private:
+    ChainedShift(ChainedShift&);
+    void operator=(ChainedShift&);
+};
+
 #endif
 
 /**
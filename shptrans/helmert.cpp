@@ -0,0 +1,212 @@
+/** 
+ * helmert.cpp - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+#include "helmert.h"
+
+#include <math.h>
+#include "math87.h"
+
+long HelmertShift::points = 0;
+
+void HelmertShift::setParameters(double const *p, double const *pv) {
+    int i;
+    for (i = 0; i < 7; ++i) params[i] = p[i];
+    for (i = 0; i < 3; ++i) pivot[i] = pv ? pv[i] : 0;
+    hasParams = true;
+    prepare();
+}
+
+void HelmertShift::setSpheroids(double aFrom, double fFrom, double aTo, double fTo) {
+    spheroids[0] = aFrom; spheroids[1] = fFrom;
+    spheroids[2] = aTo;   spheroids[3] = fTo;
+    hasSpheroids = true;
+    prepare();
+}
+
+static void set_spheroids(HelmertShift::Direction &d, double aFrom, double fFrom, double aTo, double fTo) {
+    d.aFrom = aFrom;
+    d.esqFrom = fFrom * (2 - fFrom);
+    d.aTo = aTo;
+    d.bTo = aTo * (1 - fTo);
+    d.esqTo = fTo * (2 - fTo);
+    d.epsqTo = d.esqTo / (1 - d.esqTo);
+}
+
+void HelmertShift::prepare() {
+    valid = hasParams && hasSpheroids;
+    if (!valid) return;
+    
+    const double arcsec = PI / (180 * 3600);
+    double rx = params[3] * arcsec, ry = params[4] * arcsec, rz = params[5] * arcsec;
+    double k = 1 + params[6] * 1e-6;
+    
+    // X' = k R (X - P) + P + T, with R for small angles
+    Direction &f = dir[0];
+    double r[9] = {
+        1, -rz,  ry,
+       rz,   1, -rx,
+      -ry,  rx,   1
+    };
+    int i;
+    for (i = 0; i < 9; ++i) f.m[i] = k * r[i];
+    for (i = 0; i < 3; ++i) {
+        f.t[i] = pivot[i] + params[i]
+          - (f.m[3*i] * pivot[0] + f.m[3*i+1] * pivot[1] + f.m[3*i+2] * pivot[2]);
+    }
+    
+    // and back, exactly: X = m^-1 (X' - t)
+    Direction &b = dir[1];
+    double const *m = f.m;
+    double det = m[0] * (m[4]*m[8] - m[5]*m[7])
+               - m[1] * (m[3]*m[8] - m[5]*m[6])
+               + m[2] * (m[3]*m[7] - m[4]*m[6]);
+    b.m[0] = (m[4]*m[8] - m[5]*m[7]) / det;
+    b.m[1] = (m[2]*m[7] - m[1]*m[8]) / det;
+    b.m[2] = (m[1]*m[5] - m[2]*m[4]) / det;
+    b.m[3] = (m[5]*m[6] - m[3]*m[8]) / det;
+    b.m[4] = (m[0]*m[8] - m[2]*m[6]) / det;
+    b.m[5] = (m[2]*m[3] - m[0]*m[5]) / det;
+    b.m[6] = (m[3]*m[7] - m[4]*m[6]) / det;
+    b.m[7] = (m[1]*m[6] - m[0]*m[7]) / det;
+    b.m[8] = (m[0]*m[4] - m[1]*m[3]) / det;
+    for (i = 0; i < 3; ++i) {
+        b.t[i] = -(b.m[3*i] * f.t[0] + b.m[3*i+1] * f.t[1] + b.m[3*i+2] * f.t[2]);
+    }
+    
+    set_spheroids(f, spheroids[0], spheroids[1], spheroids[2], spheroids[3]);
+    set_spheroids(b, spheroids[2], spheroids[3], spheroids[0], spheroids[1]);
+}
+
+
+/*
+  Back from ECEF, the longitude is direct, and the latitude is by
+  Bowring's method: from the reduced latitude beta, with tan(beta) =
+  (b/a) tan(lat),
+  
+    tan(lat) = (Z + e'^2 b sin^3 beta) / (p - e^2 a cos^3 beta)
+  
+  starting from tan(beta) = aZ / bp.  One round is good to about 
+  0.1mm near the surface, and a second to well under a micrometre.
+  Sine and cosine of beta follow from its tangent, so neither round
+  needs a transcendental call.
+*/
+int HelmertShift::apply(Direction const &d, double *xy, int count) {
+    if (!valid) return PROJ_E_SEQUENCE;
+    
+    points += count;
+    
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (ProjectionBase::simdLevel()) {
+      case SIMD_AVX512: done = applyAVX512(d, PointPairs(xy), count); break;
+      case SIMD_AVX2: done = applyAVX2(d, PointPairs(xy), count); break;
+      case SIMD_SSE2: done = applySSE2(d, PointPairs(xy), count); break;
+    }
+    xy += 2 * done;
+    count -= done;
+#endif
+    
+    for (int i = 0; i < count; ++i, xy += 2) {
+        double sinlat, coslat, sinlon, coslon;
+        sin_cos(xy[1] * (PI/180), &sinlat, &coslat);
+        sin_cos(xy[0] * (PI/180), &sinlon, &coslon);
+        
+        // to ECEF, on the source spheroid
+        double N = d.aFrom / sqrt(1 - d.esqFrom * sinlat * sinlat);
+        double X = N * coslat * coslon;
+        double Y = N * coslat * sinlon;
+        double Z = N * (1 - d.esqFrom) * sinlat;
+        
+        // shift
+        double X2 = d.m[0] * X + d.m[1] * Y + d.m[2] * Z + d.t[0];
+        double Y2 = d.m[3] * X + d.m[4] * Y + d.m[5] * Z + d.t[1];
+        double Z2 = d.m[6] * X + d.m[7] * Y + d.m[8] * Z + d.t[2];
+        
+        // and back, on the target spheroid
+        double p = sqrt(X2 * X2 + Y2 * Y2);
+        double tanb = (Z2 * d.aTo) / (p * d.bTo);
+        double num = 0, den = 1;
+        for (int k = 0; k < 2; ++k) {
+            double cosb = 1 / sqrt(1 + tanb * tanb);
+            double sinb = tanb * cosb;
+            num = Z2 + d.epsqTo * d.bTo * sinb * sinb * sinb;
+            den = p - d.esqTo * d.aTo * cosb * cosb * cosb;
+            tanb = (d.bTo / d.aTo) * num / den;
+        }
+        
+        xy[0] = atan2(Y2, X2) * (180/PI);
+        xy[1] = atan2(num, den) * (180/PI);
+    }
+    
+    return PROJ_SUCCESS;
+}
+
+// For separate arrays of x and y: the kernel reads them directly,
+// and the last few points go through the interleaved version.
+int HelmertShift::apply(Direction const &d, double *x, double *y, int count) {
+    if (!valid) return PROJ_E_SEQUENCE;
+    
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (ProjectionBase::simdLevel()) {
+      case SIMD_AVX512: done = applyAVX512(d, PointArrays(x, y), count); break;
+      case SIMD_AVX2: done = applyAVX2(d, PointArrays(x, y), count); break;
+      case SIMD_SSE2: done = applySSE2(d, PointArrays(x, y), count); break;
+    }
+#endif
+    points += done;
+    
+    double xy[2 * 64];
+    while (done < count) {
+        int n = (count - done < 64) ? count - done : 64;
+        soa_join(x + done, y + done, xy, n);
+        apply(d, xy, n);
+        soa_split(xy, x + done, y + done, n);
+        done += n;
+    }
+    
+    return PROJ_SUCCESS;
+}
@@ -0,0 +1,113 @@
+/** 
+ * helmert.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+#ifndef _HELMERT_H
+#define _HELMERT_H
+
+#include "projbase.h"
+
+/*
+  A datum shift without a grid: latitude and longitude are taken to
+  earth-centred, earth-fixed (ECEF) coordinates on the source spheroid,
+  moved by a seven-parameter Helmert transformation (or, about a pivot
+  point, the ten-parameter Molodensky-Badekas), and taken back to 
+  latitude and longitude on the target spheroid.  Heights are taken
+  as zero on the way in and dropped on the way out.
+  
+  This is much less accurate than NTv2 where the grid covers (typically
+  a metre or more, against a few centimetres), but it covers everywhere,
+  so it serves for data off the grid, offshore or over the border.
+*/
+class HelmertShift {
+  public:
+    HelmertShift(): valid(false), hasParams(false), hasSpheroids(false) {}
+    
+    // The transformation from the source datum to the target: 
+    // translations in metres, rotations in arc-seconds (position
+    // vector convention; negate them for coordinate frame), scale in 
+    // parts per million.  With a pivot (ECEF metres), the rotation 
+    // and scale are about it (Molodensky-Badekas).
+    void setParameters(double const *params, double const *pivot = 0);
+    void setSpheroids(double aFrom, double fFrom, double aTo, double fTo);
+    bool ready() const { return valid; }
+    
+    // Latitude and longitude in degrees, in place: forward from the 
+    // source datum to the target, reverse from the target to the source.
+    int forward(double *xy, int count) { return apply(dir[0], xy, count); }
+    int reverse(double *xy, int count) { return apply(dir[1], xy, count); }
+    int forward(double *x, double *y, int count) { return apply(dir[0], x, y, count); }
+    int reverse(double *x, double *y, int count) { return apply(dir[1], x, y, count); }
+    
+    // points shifted, for -verbose
+    static long points;
+    
+    // One direction: X' = m X + t, between two spheroids.
+    struct Direction {
+        double m[9];
+        double t[3];
+        double aFrom, esqFrom;
+        double aTo, bTo, esqTo, epsqTo;   // epsq = e'^2
+    };
+  
+  protected:
+    bool valid, hasParams, hasSpheroids;
+    double params[7];
+    double pivot[3];
+    double spheroids[4];    // a and f, from and to
+    Direction dir[2];       // forward, reverse
+    
+    void prepare();
+    int apply(Direction const &d, double *xy, int count);
+    int apply(Direction const &d, double *x, double *y, int count);
+    
+    // SIMD kernels (helmvec.h), as for the projections
+    template <class Points> static int applySSE2(Direction const &d, Points pts, int count);
+    template <class Points> static int applyAVX2(Direction const &d, Points pts, int count);
+    template <class Points> static int applyAVX512(Direction const &d, Points pts, int count);
+};
+
+#endif
@@ -0,0 +1,98 @@
+/** 
+ * helmvec.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  The SIMD version of HelmertShift::apply, as in helmert.cpp, for 
+  VEC_WIDTH points at a time; included by sse2.cpp, avx2.cpp and 
+  avx512.cpp in the same way as tmvec.h.
+*/
+
+#include <math.h>
+#include "helmert.h"
+#include "vecmath.h"
+
+template <class Points>
+int HelmertShift::VEC_NAME(apply)(Direction const &d, Points pts, int count) {
+    int done = count - count % VEC_WIDTH;
+    
+    for (int i=0; i<done; i+=VEC_WIDTH) {
+        vdouble lon, lat;
+        vec_load_pts(pts, i, &lon, &lat);
+        
+        vdouble sinlat, coslat, sinlon, coslon;
+        vec_sincos(lat * (PI/180), &sinlat, &coslat);
+        vec_sincos(lon * (PI/180), &sinlon, &coslon);
+        
+        vdouble N = d.aFrom / vec_sqrt(1 - d.esqFrom * sinlat * sinlat);
+        vdouble X = N * coslat * coslon;
+        vdouble Y = N * coslat * sinlon;
+        vdouble Z = N * (1 - d.esqFrom) * sinlat;
+        
+        vdouble X2 = d.m[0] * X + d.m[1] * Y + d.m[2] * Z + d.t[0];
+        vdouble Y2 = d.m[3] * X + d.m[4] * Y + d.m[5] * Z + d.t[1];
+        vdouble Z2 = d.m[6] * X + d.m[7] * Y + d.m[8] * Z + d.t[2];
+        
+        vdouble p = vec_sqrt(X2 * X2 + Y2 * Y2);
+        vdouble tanb = (Z2 * d.aTo) / (p * d.bTo);
+        vdouble num = vdouble(), den = vdouble();
+        for (int k = 0; k < 2; ++k) {
+            vdouble cosb = 1 / vec_sqrt(1 + tanb * tanb);
+            vdouble sinb = tanb * cosb;
+            num = Z2 + d.epsqTo * d.bTo * sinb * sinb * sinb;
+            den = p - d.esqTo * d.aTo * cosb * cosb * cosb;
+            tanb = (d.bTo / d.aTo) * num / den;
+        }
+        
+        vec_store_pts(pts, i, vec_atan2(Y2, X2) * (180/PI), vec_atan2(num, den) * (180/PI));
+    }
+    
+    return done;
+}
+
+// both layouts (see PointPairs)
+template int HelmertShift::VEC_NAME(apply)(Direction const &, PointPairs, int);
+template int HelmertShift::VEC_NAME(apply)(Direction const &, PointArrays, int);
@@ -97,6 +97,7 @@
 #include <io.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -121,6 +122,15 @@
 #define BYTESWAP(BUFFER, SIZE, COUNT)
 #endif
 
+#if defined(__GNUC__)
+#define PREFETCH(ADDR) __builtin_prefetch(ADDR)
+#elif defined(_MSC_VER) && (_MSC_VER >= 1300)
+#include <xmmintrin.h>
+#define PREFETCH(ADDR) _mm_prefetch((char const*)(ADDR), _MM_HINT_T0)
+#else
+#define PREFETCH(ADDR)
+#endif
+
 
 
 
@@ -291,6 +301,12 @@ int grid_find(gridFileType *nadPtr, double const &lon,double const &lat, int) {
     return filen;
 }
 
+static int find_subgrid(gridFileType *nadPtr, double const &lon, double const &lat, int ihint, int *limflag) {
+    int filen = grid_find(nadPtr, lon, lat, ihint);
+    *limflag = nadPtr->limflag;
+    return filen;
+}
+
 
 
 #else
@@ -298,9 +314,11 @@ int grid_find(gridFileType *nadPtr, double const &lon,double const &lat, int) {
 
 /*
  * Search the subgrid hierarchy to determine the subgrid that
- * the point falls into.
+ * the point falls into.  The result is written to *limflag rather
+ * than to the grid structure, so that several threads can search
+ * the same grid at once.
  */
-int grid_find(gridFileType *nadPtr, double const &lon,double const &lat, int ihint) {
+static int find_subgrid(gridFileType *nadPtr, double const &lon,double const &lat, int ihint, int *limflag) {
     // special case: just one subgrid.
     // does it need to be a special case?
     if (nadPtr->nfiles==1) {
@@ -311,8 +329,8 @@ int grid_find(gridFileType *nadPtr, double const &lon,double const &lat, int ihi
         (lon <= subGrid->alimit[3])) {
         
         // which sides does it just touch?
-        nadPtr->limflag = (lat == subGrid->alimit[1]);
-        if (lon == subGrid->alimit[3]) nadPtr->limflag += 2;
+        *limflag = (lat == subGrid->alimit[1]);
+        if (lon == subGrid->alimit[3]) *limflag += 2;
         return 0;
       }
       return -1;
@@ -338,6 +356,23 @@ int grid_find(gridFileType *nadPtr, double const &lon,double const &lat, int ihi
          (lon >= pTest->alimit[2]) &&
               (lon < pTest->alimit[3])) {
         piParent = hint_inject;
+
+        // in a mosaic, a file listed earlier takes priority where
+        // the files overlap, so the hint is only good if none of
+        // the earlier files' grids contain the point.
+        if (pTest->file != nadPtr) {
+          for (int *piTop = nadPtr->topGrids;
+               nadPtr->subGrid[*piTop].file != pTest->file; ++piTop) {
+            subGridType *pTop = nadPtr->subGrid + (*piTop);
+            if ((lat >= pTop->alimit[0]) &&
+               (lat <= pTop->alimit[1]) &&
+               (lon >= pTop->alimit[2]) &&
+               (lon <= pTop->alimit[3])) {
+              piParent = nadPtr->topGrids;
+              break;
+            }
+          }
+        }
       }
     }
   
@@ -365,7 +400,7 @@ int grid_find(gridFileType *nadPtr, double const &lon,double const &lat, int ihi
   
   
     if (filen >= 0) {
-      nadPtr->limflag = 0;
+      *limflag = 0;
       return filen;
       
       // according to the file description, I think we are supposed to stop 
@@ -434,144 +469,537 @@ int grid_find(gridFileType *nadPtr, double const &lon,double const &lat, int ihi
         }
     }
   
-    if (filen >= 0) nadPtr->limflag = bestLimit;
+    if (filen >= 0) *limflag = bestLimit;
   
     return filen;
 }
 
+int grid_find(gridFileType *nadPtr, double const &lon,double const &lat, int ihint) {
+    return find_subgrid(nadPtr, lon, lat, ihint, &nadPtr->limflag);
+}
+
 
 
 #endif
 
 
-/* grid_eval
+/*
+ * Read count records, starting at record rec (counting from 1),
+ * in one call.
+ */
+static int read_records(int fd, long rec, gridDataType *buff, int count) {
+    if (lseek(fd, (rec-1)*16, SEEK_SET) < 0) {
+        return GRID_ERROR;
+    }
+    if (read(fd, buff, count * sizeof(gridDataType)) != (int)(count * sizeof(gridDataType))) {
+        return GRID_ERROR;
+    }
+    return GRID_OK;
+}
+
+/*
+ * The node records of a subgrid.  With a mapped file these are 
+ * just a pointer into the view, which the system pages in as it
+ * is touched.  Otherwise the subgrid is read in, in one call, the
+ * first time a point lands in it; subgrids that the data doesn't
+ * touch are never read.
+ */
+static gridDataType const *subgrid_data(subGridType *subgrid) {
+#ifndef _WIN32
+    if (!subgrid->pData) {
+        gridDataType *data = (gridDataType*)malloc(subgrid->agscount * sizeof(gridDataType));
+        if (!data) return NULL;
+        if (read_records(subgrid->file->fd, subgrid->astart, data, subgrid->agscount) != GRID_OK) {
+            free(data);
+            return NULL;
+        }
+        BYTESWAP(data, sizeof(float), subgrid->agscount * (sizeof(gridDataType) / sizeof(float)));
+        subgrid->pData = data;
+    }
+#endif
+    return subgrid->pData;
+}
+
+
+/*
+ * Read one node's lat,lon shift from quantized storage.
+ */
+static void dequantize(quantGridType const *quant, int node, float *shift) {
+    if (quant->bits == 16) {
+        short const *n = (short const*)(quant + 1) + 2 * node;
+        shift[0] = (float)(quant->offset[0] + quant->scale[0] * n[0]);
+        shift[1] = (float)(quant->offset[1] + quant->scale[1] * n[1]);
+    } else {
+        int const *n = (int const*)(quant + 1) + 2 * node;
+        shift[0] = (float)(quant->offset[0] + quant->scale[0] * n[0]);
+        shift[1] = (float)(quant->offset[1] + quant->scale[1] * n[1]);
+    }
+}
+
+/*
+ * Quantize a subgrid to the given number of bits.  Returns NULL if
+ * the largest error would be more than subgrid->qbound.
+ */
+static quantGridType *quantize_subgrid(subGridType *subgrid, gridDataType const *data, int bits) {
+    int count = subgrid->agscount;
+    int i, j;
+    
+    quantGridType *quant = (quantGridType*)malloc(
+        sizeof(quantGridType) + count * 2 * (bits / 8)
+    );
+    if (!quant) return NULL;
+    quant->bits = bits;
+    
+    double qmax = (bits == 16) ? 32767.0 : 2147483647.0;
+    for (j = 0; j < 2; ++j) {
+        float const *v = (float const*)data + j;
+        double lo = v[0], hi = v[0];
+        for (i = 1; i < count; ++i) {
+            if (v[4*i] < lo) lo = v[4*i];
+            if (v[4*i] > hi) hi = v[4*i];
+        }
+        quant->offset[j] = (lo + hi) / 2;
+        quant->scale[j] = (hi > lo) ? (hi - lo) / 2 / qmax : 1;
+        
+        for (i = 0; i < count; ++i) {
+            double n = floor((v[4*i] - quant->offset[j]) / quant->scale[j] + 0.5);
+            if (n > qmax) n = qmax;
+            if (n < -qmax) n = -qmax;
+            if (bits == 16) {
+                ((short*)(quant + 1))[2*i + j] = (short)n;
+            } else {
+                ((int*)(quant + 1))[2*i + j] = (int)n;
+            }
+        }
+    }
+    
+    // check every node, as it will be read back
+    for (i = 0; i < count; ++i) {
+        float shift[2];
+        dequantize(quant, i, shift);
+        if (
+            (fabs(shift[0] - ((float const*)(data + i))[0]) > subgrid->qbound) ||
+            (fabs(shift[1] - ((float const*)(data + i))[1]) > subgrid->qbound)
+        ) {
+            free(quant);
+            return NULL;
+        }
+    }
+    return quant;
+}
+
+/*
+ * The quantized node data of a subgrid, or NULL if it is not
+ * quantized (see grid_quantize).
+ */
+static inline quantGridType const *subgrid_quant(subGridType *subgrid) {
+    return subgrid->pQuant;
+}
+
+
+/* grid_eval_r
  * Interpolate based on best-match subgrid for a given 
  * location.  A subgrid number may be passed; this is a hint 
  * for where to start; it is necessarily the grid that will
  * be used.
  * Return value is the matching subgrid, or less than 0 on
  * error.
+ *
+ * The shifts are written to *result, along with the partial
+ * derivatives of the bilinear surface within the cell; these 
+ * are the Jacobian used by GridShift::reverse for its Newton 
+ * steps.  Nothing is written to the grid structure once the
+ * subgrid is read in, so this may be called from several threads
+ * at once if the grid is memory-mapped (Win32), or has been read
+ * in with grid_load beforehand.
+ *
+ * If field is not NULL, it is interpolated in place of the
+ * shifts from the file.  It must hold a lat,lon pair of floats
+ * for every record in the file, or in every file of a mosaic 
+ * (see grid_alloc_field); this is
+ * how derived grids, which share the subgrid layout of the file 
+ * but not its values, are evaluated.
  */
 
-int grid_eval(
-    gridFileType *nadPtr, 
+int grid_eval_r(
+    gridFileType *nadPtr, float const *field,
     double const & lon, double const & lat,
-    int filen_hint
+    int filen_hint, gridEvalType *result
 ) {
-    int filen = grid_find(nadPtr, lon, lat, filen_hint);
+    int limflag;
+    int filen = find_subgrid(nadPtr, lon, lat, filen_hint, &limflag);
     if (filen < 0) return GRID_ERROR;
-  
-    float *se, *sw, *ne, *nw;
+    
+    return grid_interp(nadPtr, field, filen, lon, lat, result);
+}
+
+
+/* grid_interp
+ * As grid_eval_r, in a given subgrid, without searching for the
+ * best one.  The point must be within that subgrid's limits; see
+ * grid_find_box.
+ */
+
+int grid_interp(
+    gridFileType *nadPtr, float const *field, int filen,
+    double const & lon, double const & lat,
+    gridEvalType *result
+) {
+    float const *se, *sw, *ne, *nw;
   
     subGridType *subgrid = (nadPtr->subGrid + filen);
   
-    int row_idx = subgrid->nrows;
-    int col_idx = subgrid->ncols;
+    int row_idx, col_idx;
     double dbl_idx;
   
     int rec_offset;
   
-    double ns_frac = 0, ew_frac = 0;
+    double ns_frac, ew_frac;
   
-    int subgrid_offset = subgrid->astart - 1;
+    // A point on the top or right limit of the subgrid lands on 
+    // the last row or column, with a zero fraction.  (This used to
+    // be special-cased using limflag, but the test was inverted.)
+    ns_frac = modf((lat - subgrid->alimit[0]) / subgrid->alimit[4], &dbl_idx);
+    row_idx = int(dbl_idx + 1E-12);
+    if (row_idx >= subgrid->nrows - 1) { row_idx = subgrid->nrows - 1; ns_frac = 0; }
   
-    if (nadPtr->limflag < 2) { //if it's not along the top (lat) border
-        ns_frac = modf((lat - subgrid->alimit[0]) / subgrid->alimit[4], &dbl_idx);
-        row_idx = int(dbl_idx + 1E-12);
-    }
-  
-    if (!(nadPtr->limflag & 1)) { // if it's not along the right (lon) border
-        ew_frac = modf((lon - subgrid->alimit[2]) / subgrid->alimit[5], &dbl_idx);
-        col_idx = int(dbl_idx + 1E-12);
-    }
+    ew_frac = modf((lon - subgrid->alimit[2]) / subgrid->alimit[5], &dbl_idx);
+    col_idx = int(dbl_idx + 1E-12);
+    if (col_idx >= subgrid->ncols - 1) { col_idx = subgrid->ncols - 1; ew_frac = 0; }
   
     rec_offset = row_idx * subgrid->ncols + col_idx;
+    
+    // the neighbouring nodes, if they are needed
+    int north = (ns_frac > 1E-12) ? subgrid->ncols : 0;
+    int west = (ew_frac > 1E-12) ? 1 : 0;
+    
+    quantGridType const *quant = NULL;
+    float corners[8];
+
+    if (field) {
+        se = field + (subgrid->fstart - 1 + rec_offset) * 2;
+        ne = se + north * 2;
+        sw = se + west * 2;
+        nw = ne + west * 2;
+    } else if ((quant = subgrid_quant(subgrid)) != NULL) {
+        se = corners;     dequantize(quant, rec_offset, corners);
+        ne = corners + 2; dequantize(quant, rec_offset + north, corners + 2);
+        sw = corners + 4; dequantize(quant, rec_offset + west, corners + 4);
+        nw = corners + 6; dequantize(quant, rec_offset + north + west, corners + 6);
+    } else {
+        gridDataType const *data = subgrid_data(subgrid);
+        if (!data) return GRID_ERROR;
+        se = (float const*)(data + rec_offset);
+        ne = (float const*)(data + rec_offset + north);
+        sw = (float const*)(data + rec_offset + west);
+        nw = (float const*)(data + rec_offset + north + west);
+    }
+
+
+    double sval = se[0] + (sw[0]-se[0])*ew_frac;
+    double nval = ne[0] + (nw[0]-ne[0])*ew_frac;
+    result->diflat = sval + (nval-sval)*ns_frac;
+    result->dlatdy = (nval-sval) / subgrid->alimit[4];
+    result->dlatdx = ((sw[0]-se[0]) + ((nw[0]-ne[0]) - (sw[0]-se[0]))*ns_frac) / subgrid->alimit[5];
   
-    gridDataType *rec = nadPtr->pGrid + (subgrid_offset +  rec_offset);
-  
-    se = ne = (float*)rec;
-    if (ns_frac > 1E-12) {
-        ne = (float*)(rec + subgrid->ncols);
+    sval = se[1] + (sw[1]-se[1])*ew_frac;
+    nval = ne[1] + (nw[1]-ne[1])*ew_frac;
+    result->diflon = sval + (nval-sval)*ns_frac;
+    result->dlondy = (nval-sval) / subgrid->alimit[4];
+    result->dlondx = ((sw[1]-se[1]) + ((nw[1]-ne[1]) - (sw[1]-se[1]))*ns_frac) / subgrid->alimit[5];
+
+#ifdef ACCURACIES
+    if (!field && !quant) {
+        for (int i=0; i<4; ++i) { 
+            sval = se[i] + (sw[i]-se[i])*ew_frac;
+            nval = ne[i] + (nw[i]-ne[i])*ew_frac;
+            result->shift[i ^ 1] = sval + (nval-sval)*ns_frac;
+        }
     }
+#endif
+
+    return filen;
+}
+
+
+/* grid_cell
+ * The cell of the grid that lon,lat (in the units of grid_find) is
+ * interpolated in: cell[0] is the subgrid, and cell[1] the record of
+ * its south-east node, as grid_interp takes them.  The shift is
+ * bilinear within a cell, with a kink or a step at its edges.  
+ * Returns the subgrid, or -1 (and cell -1,-1) if lon,lat is outside
+ * the grid.
+ */
+int grid_cell(gridFileType *nadPtr, double const &lon, double const &lat, int filen_hint, int *cell) {
+    int limflag;
+    int filen = find_subgrid(nadPtr, lon, lat, filen_hint, &limflag);
+    
+    cell[0] = cell[1] = -1;
+    if (filen < 0) return -1;
+    
+    // as grid_interp
+    subGridType *subgrid = (nadPtr->subGrid + filen);
+    double dbl_idx;
+    
+    modf((lat - subgrid->alimit[0]) / subgrid->alimit[4], &dbl_idx);
+    int row_idx = int(dbl_idx + 1E-12);
+    if (row_idx >= subgrid->nrows - 1) row_idx = subgrid->nrows - 1;
+    
+    modf((lon - subgrid->alimit[2]) / subgrid->alimit[5], &dbl_idx);
+    int col_idx = int(dbl_idx + 1E-12);
+    if (col_idx >= subgrid->ncols - 1) col_idx = subgrid->ncols - 1;
     
-    sw = se; nw = ne;
-    if (ew_frac > 1E-12) { nw += 4; sw += 4; }
+    cell[0] = filen;
+    cell[1] = row_idx * subgrid->ncols + col_idx;
+    return filen;
+}
 
 
-#ifndef _WIN32
-#define COPY_GRID_RECORD(corner, buf_idx) \
-  _lseek(nadPtr->fd, (long)(corner), SEEK_SET); \
-  _read(nadPtr->fd, gridBuf + buf_idx, sizeof(gridDataType)); \
-  corner = (float*)(gridBuf + buf_idx);
-  	 
-    // this is not very efficient... but mmap is so problematic
-  
-    gridDataType gridBuf[4];
+/* grid_find_box
+ * The subgrid that grid_find would choose for every point in the
+ * box (min lon, min lat, max lon, max lat, in the units of 
+ * grid_find), or -1 if that is not the same subgrid throughout, or
+ * if any of the box is outside the grid.  The points in the box
+ * can then be passed straight to grid_interp, skipping the search.
+ *
+ * At each level of the tree, the first grid that overlaps the box
+ * at all (which is the one grid_find would try first) must wholly
+ * contain it; the answer is the last such grid, once none of its 
+ * children overlap the box.
+ */
 
-    COPY_GRID_RECORD(ne, 0);
-    COPY_GRID_RECORD(nw, 1);
-    COPY_GRID_RECORD(se, 2);
-    COPY_GRID_RECORD(sw, 3);
-  
-    BYTESWAP(gridBuf, sizeof(float), sizeof(gridBuf) / sizeof(float));
-  
-#undef COPY_GRID_RECORD  
+int grid_find_box(gridFileType *nadPtr, double const *box) {
+    int filen = -1;
+    int *piParent = nadPtr->topGrids;
+    
+    while (piParent) {
+        subGridType *pTest = NULL;
+        
+        for (; *piParent >= 0; ++piParent) {
+            pTest = nadPtr->subGrid + (*piParent);
+            if ((box[3] >= pTest->alimit[0]) &&
+                (box[1] <= pTest->alimit[1]) &&
+                (box[2] >= pTest->alimit[2]) &&
+                (box[0] <= pTest->alimit[3])) {
+                break;
+            }
+        }
+        if (*piParent < 0) {
+            return filen;
+        }
+        
+        // the same test as find_subgrid uses for each point
+        if (!((box[1] >= pTest->alimit[0]) &&
+              (box[3] <  pTest->alimit[1]) &&
+              (box[0] >= pTest->alimit[2]) &&
+              (box[2] <  pTest->alimit[3]))) {
+            return -1;
+        }
+        
+        filen = *piParent;
+        piParent = pTest->children;
+    }
+    return filen;
+}
+
+
+/* grid_prefetch
+ * Start loading the nodes that points in the box (as for 
+ * grid_find_box) will need into the cache, so that the loads
+ * overlap with other work.  field is as for grid_eval_r.  This
+ * is only a hint: nothing is done if the box is not in a single
+ * subgrid, or if that subgrid's data has not been read in yet.
+ */
+
+void grid_prefetch(gridFileType *nadPtr, float const *field, double const *box) {
+    int filen = grid_find_box(nadPtr, box);
+    if (filen < 0) return;
+    
+    subGridType *subgrid = nadPtr->subGrid + filen;
+    char const *data;
+    int nodeSize;
+    
+    if (field) {
+        data = (char const*)(field + 2 * (subgrid->fstart - 1));
+        nodeSize = 2 * sizeof(float);
+    } else if (subgrid->pQuant) {
+        data = (char const*)(subgrid->pQuant + 1);
+        nodeSize = subgrid->pQuant->bits / 4;
+    } else if (subgrid->pData) {
+        data = (char const*)subgrid->pData;
+        nodeSize = sizeof(gridDataType);
+    } else {
+        return;
+    }
+    
+    int row0 = int((box[1] - subgrid->alimit[0]) / subgrid->alimit[4]);
+    int row1 = int((box[3] - subgrid->alimit[0]) / subgrid->alimit[4]) + 1;
+    int col0 = int((box[0] - subgrid->alimit[2]) / subgrid->alimit[5]);
+    int col1 = int((box[2] - subgrid->alimit[2]) / subgrid->alimit[5]) + 1;
+    if (row1 >= subgrid->nrows) row1 = subgrid->nrows - 1;
+    if (col1 >= subgrid->ncols) col1 = subgrid->ncols - 1;
+    
+    // a large record will be slow anyway; don't flood the cache
+    if ((row1 - row0 + 1) * (col1 - col0 + 1) > 4096) return;
+    
+    for (int row = row0; row <= row1; ++row) {
+        char const *first = data + (row * subgrid->ncols + col0) * nodeSize;
+        char const *last = data + (row * subgrid->ncols + col1) * nodeSize;
+        for (; first <= last; first += 64) {
+            PREFETCH(first);
+        }
+        PREFETCH(last);
+    }
+}
+
+
+/* grid_eval
+ * As grid_eval_r, for the shifts in the file, but the result is
+ * stored in the grid structure (diflat, diflon).
+ */
+
+int grid_eval(
+    gridFileType *nadPtr, 
+    double const & lon, double const & lat,
+    int filen_hint
+) {
+    gridEvalType result;
+    int filen = grid_eval_r(nadPtr, 0, lon, lat, filen_hint, &result);
+    if (filen < 0) return GRID_ERROR;
+    
+    nadPtr->diflat = result.diflat;
+    nadPtr->diflon = result.diflon;
+#ifdef ACCURACIES
+    memcpy(nadPtr->shift, result.shift, sizeof(nadPtr->shift));
 #endif
+    return filen;
+}
 
 
+/* grid_alloc_field
+ * Allocate a zeroed lat,lon pair of floats for every record in
+ * the file, for use with grid_eval_r.  Release it with free().
+ * Node n of a subgrid is at index fstart-1+n.
+ */
+
+float *grid_alloc_field(gridFileType *nadPtr) {
+    return (float*)calloc(nadPtr->nRecs, 2 * sizeof(float));
+}
 
-#ifndef ACCURACIES
-    double sval = se[0] + (sw[0]-se[0])*ew_frac;
-    double nval = ne[0] + (nw[0]-ne[0])*ew_frac;
-    nadPtr->diflat = sval + (nval-sval)*ns_frac;
-  
-    sval = se[1] + (sw[1]-se[1])*ew_frac;
-    nval = ne[1] + (nw[1]-ne[1])*ew_frac;
-    nadPtr->diflon = sval + (nval-sval)*ns_frac;
 
+/* grid_quantize
+ * Store the shifts as scaled 16 or 32-bit integers, where that is
+ * within max_error (arc-seconds) of the values in the file, to cut
+ * memory use and cache traffic.  Every subgrid is quantized now,
+ * so that the cost, and whether the bound can be met, are known
+ * up front; counts (if not NULL) gets the number of subgrids
+ * stored in 16 bits, in 32 bits, and left as they are.
+ *
+ * The records of the quantized subgrids are then released: freed
+ * if they were read in, or on Win32, the view of the file is 
+ * unmapped if all of its subgrids were quantized.  So this can 
+ * only be done once, and applies to the files already attached to
+ * a mosaic; it should be called after they are all open.
+ */
+int grid_quantize(gridFileType *nadPtr, double max_error, int *counts) {
+#ifdef ACCURACIES
+    // only the shifts are quantized, not the accuracies
+    return GRID_ERROR;
 #else
-  
-    for (int i=0; i<4; ++i) { 
-        double sval = se[i] + (sw[i]-se[i])*ew_frac;
-        double nval = ne[i] + (nw[i]-ne[i])*ew_frac;
-        nadPtr->shift[i ^ 1] = sval + (nval-sval)*ns_frac;
+    int i;
+    if (counts) counts[0] = counts[1] = counts[2] = 0;
+    
+    for (i = 0; i < nadPtr->nfiles; ++i) {
+        subGridType *subgrid = nadPtr->subGrid + i;
+        if (subgrid->pQuant) return GRID_ERROR;  // done already
+        subgrid->qbound = max_error;
+        if (max_error <= 0) continue;
+        
+        gridDataType const *data = subgrid_data(subgrid);
+        if (!data) return GRID_ERROR;
+        
+        quantGridType *quant = quantize_subgrid(subgrid, data, 16);
+        if (!quant) quant = quantize_subgrid(subgrid, data, 32);
+        if (counts) ++counts[quant ? (quant->bits == 16 ? 0 : 1) : 2];
+        if (!quant) continue;
+        
+        subgrid->pQuant = quant;
+#ifndef _WIN32
+        free(subgrid->pData);
+#endif
+        subgrid->pData = NULL;
+    }
+    
+#ifdef _WIN32
+    for (gridFileType *file = nadPtr; file; file = file->next) {
+        for (i = 0; i < nadPtr->nfiles; ++i) {
+            if (nadPtr->subGrid[i].file == file && nadPtr->subGrid[i].pData) break;
+        }
+        if (i == nadPtr->nfiles && file->pGrid) {
+            UnmapViewOfFile(file->pGrid);
+            file->pGrid = NULL;
+        }
     }
-  
-    nadPtr->diflon = nadPtr->shift[0];
-    nadPtr->diflat = nadPtr->shift[1];
-
 #endif
+    return GRID_OK;
+#endif
+}
 
-    return filen;
+
+/*
+ * Read in the records of every subgrid not read in (or quantized)
+ * already.  subgrid_data reads them lazily, which is not safe from
+ * several threads at once, so this is done before starting any
+ * that will evaluate the grid (see FieldBuilder).  With a mapped
+ * file there is nothing to do.
+ */
+int grid_load(gridFileType *nadPtr) {
+    for (int i = 0; i < nadPtr->nfiles; ++i) {
+        subGridType *subgrid = nadPtr->subGrid + i;
+        if (subgrid->pQuant) continue;
+        if (!subgrid_data(subgrid)) return GRID_ERROR;
+    }
+    return GRID_OK;
 }
 
 
 
 #define GET_INT(REC, VAR) \
-    lseek(nadPtr->fd, ((REC)-1)*16, SEEK_SET); \
-    read(nadPtr->fd, &buff, 16); \
-    VAR = buff.value.i; \
+    VAR = (REC).value.i; \
     BYTESWAP(&VAR, sizeof(VAR), 1);
 
 #define GET_CHAR(REC, VAR) \
-    lseek(nadPtr->fd, ((REC)-1)*16, SEEK_SET); \
-    read(nadPtr->fd, &buff, 16); \
-    strncpy(VAR, buff.value.c, 8); \
+    strncpy(VAR, (REC).value.c, 8); \
     {char *s; for(s=(VAR)+7; s>=(VAR) && (*s==0 || *s == ' '); *s--=0) {}}
 
 #define GET_DBL(REC, VAR) \
-    lseek(nadPtr->fd, ((REC)-1)*16, SEEK_SET); \
-    read(nadPtr->fd, &buff, 16); \
-    VAR = buff.value.d; \
+    VAR = (REC).value.d; \
     BYTESWAP(&VAR,sizeof(VAR),1);
 
+// The overview and subfile headers are 11 records each.
+#define HEADER_RECS 11
+
+/*
+ * Subgrid names are only used to link each subgrid to its parent,
+ * which is done through a small hash table rather than comparing
+ * every pair of names; some grids have thousands of subgrids.
+ */
+static unsigned name_hash(char const *name) {
+    unsigned h = 0;
+    for (int i = 0; i < 8 && name[i]; ++i) {
+        h = h * 31 + (unsigned char)name[i];
+    }
+    return h;
+}
+
 /*
  * Initialize the conversion by reading in the subgrid headers.
+ * The node data is not read until it is needed (see subgrid_data).
  */
 gridFileType *grid_open(char *filename, char *fdatum, char *tdatum) {
     gridFileType *nadPtr;
     int i, j, count;
-    gridDataType buff;
+    gridDataType buff[HEADER_RECS];
     subGridType *subGrid;
     nadPtr = (NAD_DATA*)calloc(1,sizeof(NAD_DATA));
     if (!nadPtr) {
@@ -589,20 +1017,32 @@ gridFileType *grid_open(char *filename, char *fdatum, char *tdatum) {
         free(nadPtr);
         return NULL;
     }
+    
+    // the size and modification time, so that anything derived
+    // from the file (see gshift.cpp) can tell if it has changed
+    struct stat st;
+    if (fstat(nadPtr->fd, &st) == 0) {
+        nadPtr->fsize = (double)st.st_size;
+        nadPtr->fmtime = (double)st.st_mtime;
+    }
   
     nadPtr->offset = 0;
   
-    GET_INT(1,nadPtr->norecs);
-    GET_INT(2,nadPtr->nsrecs);
-    GET_INT(3,nadPtr->nfiles);
-    GET_CHAR(4,nadPtr->typout);
-    GET_CHAR(5,nadPtr->version);
-    GET_CHAR(6,nadPtr->fdatum);
-    GET_CHAR(7,nadPtr->tdatum);
-    GET_DBL(8,nadPtr->fellips[0]);
-    GET_DBL(9,nadPtr->fellips[1]);
-    GET_DBL(10,nadPtr->tellips[0]);
-    GET_DBL(11,nadPtr->tellips[1]);
+    if (read_records(nadPtr->fd, 1, buff, HEADER_RECS) != GRID_OK) {
+        grid_close(nadPtr);
+        return NULL;
+    }
+    GET_INT(buff[0],nadPtr->norecs);
+    GET_INT(buff[1],nadPtr->nsrecs);
+    GET_INT(buff[2],nadPtr->nfiles);
+    GET_CHAR(buff[3],nadPtr->typout);
+    GET_CHAR(buff[4],nadPtr->version);
+    GET_CHAR(buff[5],nadPtr->fdatum);
+    GET_CHAR(buff[6],nadPtr->tdatum);
+    GET_DBL(buff[7],nadPtr->fellips[0]);
+    GET_DBL(buff[8],nadPtr->fellips[1]);
+    GET_DBL(buff[9],nadPtr->tellips[0]);
+    GET_DBL(buff[10],nadPtr->tellips[1]);
   
     /*
      * Confirm that the source and target datums are correct.
@@ -610,7 +1050,8 @@ gridFileType *grid_open(char *filename, char *fdatum, char *tdatum) {
      */
     if (
         ((fdatum && strncmp(fdatum, nadPtr->fdatum, 8)) != 0) ||
-        ((tdatum && strncmp(tdatum, nadPtr->tdatum, 8)) != 0)
+        ((tdatum && strncmp(tdatum, nadPtr->tdatum, 8)) != 0) ||
+        (nadPtr->nfiles < 1)
     ) {
       grid_close(nadPtr);
       return NULL;
@@ -626,34 +1067,39 @@ gridFileType *grid_open(char *filename, char *fdatum, char *tdatum) {
     }
   
     /*
-     * Loop through all of the subgrid header records.  Skip
-     * over the actual adjustment data (don't read the detail until
-     * later).
+     * Loop through all of the subgrid header records, reading
+     * each header in one call.  Skip over the actual adjustment 
+     * data (don't read the detail until later).
      */
     count = nadPtr->norecs;
     for (i=0;i<nadPtr->nfiles;i++) {
         subGrid = nadPtr->subGrid + i;
-        count++;
+        subGrid->file = nadPtr;
+        subGrid->parent = -1;
+        
+        if (read_records(nadPtr->fd, count + 1, buff, HEADER_RECS) != GRID_OK) {
+            grid_close(nadPtr);
+            return NULL;
+        }
+        
         /*
          * Read the name of the sub grid, and validate that this
          * is a correct record.
          */
-        GET_CHAR(count, subGrid->anameg);
-        if (strncmp(buff.title, "SUB_NAME", 8) != 0) {
+        GET_CHAR(buff[0], subGrid->anameg);
+        if (strncmp(buff[0].title, "SUB_NAME", 8) != 0) {
             grid_close(nadPtr);
             return NULL;
         }
-        count++;
-        GET_CHAR(count, subGrid->apgrid);
-        count += 3;
+        GET_CHAR(buff[1], subGrid->apgrid);
         /*
          * Read the limits of this subgrid.
          */
         for (j=0; j<6; j++) {
-            GET_DBL(count, subGrid->alimit[j]);
-            count++;
+            GET_DBL(buff[4+j], subGrid->alimit[j]);
         }
-        GET_INT(count,  subGrid->agscount);
+        GET_INT(buff[10], subGrid->agscount);
+        count += HEADER_RECS;
         
         subGrid->ncols = int( (subGrid->alimit[3] - subGrid->alimit[2]) 
                               / subGrid->alimit[5] + 1E-10) + 1;
@@ -665,23 +1111,58 @@ gridFileType *grid_open(char *filename, char *fdatum, char *tdatum) {
             return NULL;
         }
     
-        nadPtr->subGrid[i].astart = count + 1;
-        count += nadPtr->subGrid[i].agscount;
+        subGrid->astart = count + 1;
+        subGrid->fstart = count + 1;
+        count += subGrid->agscount;
     }
+    nadPtr->nRecs = count;
   
   
-    if (nadPtr->nfiles != 1) {
+    if (nadPtr->nfiles == 1) {
+        // no tree to speak of, but a mosaic (see grid_attach) 
+        // still needs the list of top-level grids.
+        nadPtr->topGrids = (int*)calloc(2, sizeof(int));
+        if (!nadPtr->topGrids) { grid_close(nadPtr); return NULL; }
+        nadPtr->topGrids[1] = -1;
+    } else {
         subGrid = nadPtr->subGrid;
-        int ichild, nchildren, ntop = 0;
+        int ichild, ntop = 0;
+        
+        /*
+         * Resolve each subgrid's parent name to an index.
+         */
+        int tableMask = 1;
+        while (tableMask < 2 * nadPtr->nfiles) tableMask <<= 1;
+        int *table = (int*)malloc(tableMask * sizeof(int));
+        if (!table) { grid_close(nadPtr); return NULL; }
+        --tableMask;
+        
+        for (j = 0; j <= tableMask; ++j) table[j] = -1;
+        for (i = 0; i < nadPtr->nfiles; ++i) {
+            j = name_hash(subGrid[i].anameg) & tableMask;
+            while (table[j] >= 0) j = (j + 1) & tableMask;
+            table[j] = i;
+        }
+        
         for (i = 0; i < nadPtr->nfiles; ++i) {
             if (0==strncmp(subGrid[i].apgrid, "NONE",6)) {
                 ntop++;
+                continue;
+            }
+            for (j = name_hash(subGrid[i].apgrid) & tableMask; table[j] >= 0; j = (j + 1) & tableMask) {
+                if (0 == strncmp(subGrid[table[j]].anameg, subGrid[i].apgrid, 8)) {
+                    subGrid[i].parent = table[j];
+                    subGrid[table[j]].nchildren++;
+                    break;
+                }
             }
         }
+        free(table);
         
         if (ntop==0) { grid_close(nadPtr); return NULL; }
     
         nadPtr->topGrids = (int*)calloc(ntop+1, sizeof(int));
+        if (!nadPtr->topGrids) { grid_close(nadPtr); return NULL; }
         nadPtr->topGrids[ntop] = -1;
         ntop = 0;
         for (i = 0; i < nadPtr->nfiles; ++i) {
@@ -690,23 +1171,22 @@ gridFileType *grid_open(char *filename, char *fdatum, char *tdatum) {
             }
         }
         
-    
         for (i = 0; i < nadPtr->nfiles; ++i) {
-            nchildren = 0;
-            for (j = 0; j < nadPtr->nfiles; ++j) {
-                if (0==strncmp(subGrid[i].anameg, subGrid[j].apgrid,6)) {
-                    nchildren++;
-                }
-            }
-            if (nchildren) {
+            if (subGrid[i].nchildren) {
                 subGrid[i].children = (int*)
-                                      calloc(nchildren + 1, sizeof(int));
-                subGrid[i].children[nchildren] = -1;
-                for (j = 0, ichild = 0; j < nadPtr->nfiles; ++j) {
-                    if (0 == strncmp(subGrid[i].anameg, subGrid[j].apgrid,6)) {
-                        subGrid[i].children[ichild++] = j;
-                    }
-                }
+                                      calloc(subGrid[i].nchildren + 1, sizeof(int));
+                if (!subGrid[i].children) { grid_close(nadPtr); return NULL; }
+                subGrid[i].children[subGrid[i].nchildren] = -1;
+            }
+        }
+        for (i = 0; i < nadPtr->nfiles; ++i) {
+            subGrid[i].nchildren = 0;
+        }
+        for (i = 0; i < nadPtr->nfiles; ++i) {
+            int parent = subGrid[i].parent;
+            if (parent >= 0) {
+                ichild = subGrid[parent].nchildren++;
+                subGrid[parent].children[ichild] = i;
             }
         }
     }
@@ -746,6 +1226,10 @@ gridFileType *grid_open(char *filename, char *fdatum, char *tdatum) {
         free(nadPtr);
         return NULL;
     }
+
+    for (i = 0; i < nadPtr->nfiles; ++i) {
+        nadPtr->subGrid[i].pData = nadPtr->pGrid + (nadPtr->subGrid[i].astart - 1);
+    }
 # endif
   
     return nadPtr;
@@ -775,15 +1259,83 @@ void grid_close(gridFileType *nadPtr) {
     if (nadPtr->subGrid) {
         for (int i = 0; i < nadPtr->nfiles; i++) {
             free(nadPtr->subGrid[i].children);
+            free(nadPtr->subGrid[i].pQuant);
+# ifndef _WIN32
+            free(nadPtr->subGrid[i].pData);
+# endif
         }
         free(nadPtr->subGrid);
     }
+    free(nadPtr->topGrids);
+
+    grid_close(nadPtr->next);
 
     free(nadPtr);
 }
 
 
 
+/*
+ * Add the subgrids of another file to a grid, so that the two
+ * are searched as one (a mosaic).  The other file's top-level 
+ * grids are searched after those already in the mosaic, so
+ * where they overlap, the file attached first has priority.
+ * Subgrid numbers in the mosaic are unchanged; the other file's
+ * are renumbered to follow them.  The other file is owned by
+ * the mosaic from now on, and is closed with it.
+ */
+int grid_attach(gridFileType *nadPtr, gridFileType *other) {
+    if (
+        strncmp(nadPtr->fdatum, other->fdatum, 8) ||
+        strncmp(nadPtr->tdatum, other->tdatum, 8)
+    ) {
+        return GRID_ERROR;
+    }
+    
+    int nfiles = nadPtr->nfiles + other->nfiles;
+    int ntop = 0, nothertop = 0;
+    int i;
+    
+    while (nadPtr->topGrids[ntop] >= 0) ++ntop;
+    while (other->topGrids[nothertop] >= 0) ++nothertop;
+    
+    subGridType *subGrid = (subGridType*)realloc(nadPtr->subGrid, nfiles * sizeof(subGridType));
+    if (!subGrid) return GRID_ERROR;
+    nadPtr->subGrid = subGrid;
+    
+    int *topGrids = (int*)realloc(nadPtr->topGrids, (ntop + nothertop + 1) * sizeof(int));
+    if (!topGrids) return GRID_ERROR;
+    nadPtr->topGrids = topGrids;
+    
+    for (i = 0; i <= nothertop; ++i) {
+        topGrids[ntop + i] = other->topGrids[i] < 0 ? -1 : other->topGrids[i] + nadPtr->nfiles;
+    }
+    
+    // the children lists and node data move to the mosaic
+    subGrid += nadPtr->nfiles;
+    memcpy(subGrid, other->subGrid, other->nfiles * sizeof(subGridType));
+    for (i = 0; i < other->nfiles; ++i) {
+        subGrid[i].fstart += nadPtr->nRecs;
+        for (int *child = subGrid[i].children; child && *child >= 0; ++child) {
+            *child += nadPtr->nfiles;
+        }
+        if (subGrid[i].parent >= 0) subGrid[i].parent += nadPtr->nfiles;
+        other->subGrid[i].children = NULL;
+        other->subGrid[i].pData = NULL;
+        other->subGrid[i].pQuant = NULL;
+    }
+    
+    nadPtr->nfiles = nfiles;
+    nadPtr->nRecs += other->nRecs;
+    
+    other->next = nadPtr->next;
+    nadPtr->next = other;
+    
+    return GRID_OK;
+}
+
+
+
 
 /**
  * NTv2 Support:
@@ -78,14 +78,28 @@
  */
 
 struct gridFileType;
+struct gridDataType;
+struct gridEvalType;
+struct quantGridType;
 
 
 gridFileType *grid_open(char *filename, char *fdatum, char *tdatum);
 
 void grid_close(gridFileType *gridPtr);
+int grid_attach(gridFileType *gridPtr, gridFileType *other);
 
 int grid_find(gridFileType *gridPtr, double const &x_lon, double const &y_lat, int filen_hint = -1);
 int grid_eval(gridFileType *gridPtr, double const &x_lon, double const & y_lat, int filen_hint = -1);
+int grid_eval_r(gridFileType *gridPtr, float const *field, double const &x_lon, double const &y_lat, int filen_hint, gridEvalType *result);
+int grid_find_box(gridFileType *gridPtr, double const *box);
+void grid_prefetch(gridFileType *gridPtr, float const *field, double const *box);
+int grid_interp(gridFileType *gridPtr, float const *field, int filen, double const &x_lon, double const &y_lat, gridEvalType *result);
+int grid_cell(gridFileType *gridPtr, double const &x_lon, double const &y_lat, int filen_hint, int *cell);
+
+float *grid_alloc_field(gridFileType *gridPtr);
+
+int grid_quantize(gridFileType *gridPtr, double max_error, int *counts = 0);
+int grid_load(gridFileType *gridPtr);
 
 
 /*
@@ -102,6 +116,12 @@ struct subGridType {
     char anameg[8], apgrid[8];
     int nrows, ncols;
     int *children;
+    int parent, nchildren;
+    gridFileType *file;			/* file holding the node data */
+    int fstart;				/* astart, counted across a mosaic */
+    gridDataType *pData;		/* node data, once it is needed */
+    double qbound;			/* quantize to within this (see grid_quantize) */
+    quantGridType *pQuant;		/* quantized node data (see grid_quantize) */
 };
 
 struct gridDataType {
@@ -113,6 +133,27 @@ struct gridDataType {
     } value;
 };
 
+/*
+ * Shifts stored as scaled integers: lat = offset[0] + scale[0] * n
+ * for each node's first value n, and likewise for lon.  The nodes
+ * follow the header, as pairs of shorts (bits == 16) or ints (32).
+ */
+struct quantGridType {
+    int bits;
+    double scale[2];
+    double offset[2];
+};
+
+struct gridEvalType {
+    double diflat;			/* interpolated lat shift */
+    double diflon;			/* interpolated lon shift */
+    double dlatdx, dlatdy;		/* partials of diflat wrt lon, lat */
+    double dlondx, dlondy;		/* partials of diflon wrt lon, lat */
+#ifdef ACCURACIES
+    double shift[4];
+#endif
+};
+
 struct gridFileType {
     int fd2;
     int fd;
@@ -142,6 +183,8 @@ struct gridFileType {
     void *hMap;
     void *hFile;
     int nRecs;
+    double fsize, fmtime;		/* identify the file (see grid_open) */
+    gridFileType *next;			/* other files in a mosaic */
 };
 
       
@@ -80,7 +80,12 @@ FORCE_ALIGN:  Force the double precision numbers
               no difference on Intel, but on
               Sparc you seem to get a bus
               error without it.  (Defaults to
-              1 on non-Intel hardware.)
+              1 on non-Intel hardware.)  The
+              points are always copied out,
+              into separate x and y arrays
+              (see soa_array), so this now
+              only applies to the bounding
+              box.
 
 BIGENDIAN:    It is assumed that if _X86_ isn't
               defined, the system is big-endian.
@@ -129,13 +134,20 @@ BIGENDIAN:    It is assumed that if _X86_ isn't
 #include "projbase.h"
 #include "dstereo.h"
 #include "tmerc.h"
+#include "webmerc.h"
+#include "pipeline.h"
+#include "surrogate.h"
+#include "helmert.h"
 
 
 
 void showusage(FILE *file) {
     if (file) {
         fputs(
-        "Usage: shptrans <inshp> <outshp | -inplace> {-precise}\n"
+        "Usage: shptrans <inshp> <outshp | -inplace> {-precise} {-invgrid} {-chaingrid}\n"
+        "                {-sharegrid} {-quantgrid{=mm}} {-kruger} {-memolat} {-nosimd}\n"
+        "                {-tolerance=distance} {-fast} {-surrogate{=distance}}\n"
+        "                {-helmert=tx,ty,tz,rx,ry,rz,ppm{,px,py,pz}} {-gridfree}\n"
         "                -from=<proj,datum{,units}> {-fromoffset=x,y} {-fromscale=k}\n"
         "                -to=<proj,datum{,units}> {-tooffset=x,y} {-toscale=k}\n"
         "       shptrans {-usage|-help|-version|-credits|-license}\n"
@@ -264,7 +276,7 @@ void showhelp(FILE *file) {
         showusage(file);
 
         fputs("\n\n"
-        "SUPPORTED PROJECTIONS: UTM, MTM, NBDS, GEO\n"
+        "SUPPORTED PROJECTIONS: UTM, MTM, NBDS, WEBMERC, TILE, GEO\n"
         "  UTM: Universal Transverse Mercator\n"
         "      Append zone number, e.g. utm20\n"
         "      Append S for southern hemisphere (false northing 10000000m).\n"
@@ -281,6 +293,14 @@ void showhelp(FILE *file) {
         "  PEIDS: PEI Double Stereographic\n"
         "      False offsets are inferred from the datum according to\n"
         "      Prince Edward Island standards.\n"
+        "  WEBMERC: Web Mercator, as used by web maps (EPSG:3857 on NAD83).\n"
+        "      The latitude/longitude of the datum is projected onto a sphere\n"
+        "      of radius 6378137m; latitudes beyond 85.0511 degrees are clipped.\n"
+        "  TILE: Web Mercator as whole pixels of the web map tiles.\n"
+        "      Append the zoom level (0 to 30), e.g. tile14.  Pixels are counted\n"
+        "      from the top left of the world, 256 to a tile, so that the tile is\n"
+        "      the pixel divided by 256.  From tile pixels, the centre of each\n"
+        "      pixel is used.  Units, offsets and scale can't be overridden.\n"
         "  GEO: No projection.  Use geographic latitude/longitude.\n"
         "      If only the datum is specified, this is the default.\n\n"
 
@@ -304,13 +324,17 @@ void showhelp(FILE *file) {
         "    the ATS77 gridshift files in the standard location, pedata\\ntv2\\canada.\n"
         "  * For ATS77 to/from NAD27, both of the above are required, and NAD83 is used\n"
         "    as an intermediate step.\n"
-        "  * If more than one gridshift file of a given type (ATS77 or NAD27) is found,\n"
-        "    SHPTRANS will arbitrarily choose one of them.  However, SHPTRANS always\n"
-        "    checks the environment variables before searching the default locations,\n"
-        "    so you can avoid ambiguity by specifying the full path to the gridshift\n"
-        "    file (including the filename itself) in the environment.  For example, if\n"
-        "    you sometimes work in New Brunswick, and other times in PEI, you may need\n"
-        "    to set the environment variable SHPTRANS_GRIDSHIFT_7783.\n\n"
+        "  * If more than one ATS77 gridshift file is found, they are all used, so that\n"
+        "    data spanning several provinces can be converted in one pass.  Where the\n"
+        "    files overlap, the first one found is used, in the order listed above:\n"
+        "    NB7783V2, NS7783V2, NS778301, PE7783V2, then GS7783.  To use a different\n"
+        "    order, or only some of the files, set SHPTRANS_GRIDSHIFT_7783 to the full\n"
+        "    path of a file, or to a list of full paths separated by semicolons.\n"
+        "  * If more than one NAD27 gridshift file is found, SHPTRANS will arbitrarily\n"
+        "    choose one of them.  However, SHPTRANS always checks the environment\n"
+        "    variables before searching the default locations, so you can avoid\n"
+        "    ambiguity by specifying the full path to the gridshift file (including\n"
+        "    the filename itself) in the environment.\n\n"
 
         "SUPPORTED UNITS FOR PROJECTED COORDINATE SYSTEMS:\n"
         "    If the coordinate system is projected, the default units are meters.\n"
@@ -353,8 +377,99 @@ void showhelp(FILE *file) {
         "    is needed for typical GIS uses.  The -precise option sets an even lower\n"
         "    tolerance, and may yield better results for higher precision datasets or\n"
         "    where the data will be projected back and forth many times.\n"
+        "  -tolerance=distance: Instead of the fixed tolerances used by default and\n"
+        "    by -precise, stop the reverse projections and reverse gridshifts as soon\n"
+        "    as the error left is within the given distance, in the output units (or\n"
+        "    in meters, if the output is lat/long).  e.g. -tolerance=0.0001 stops within\n"
+        "    a tenth of a millimetre in meters, which takes fewer iterations than the\n"
+        "    default.  With -verbose, the iterations taken and the largest error left\n"
+        "    are reported.\n"
+        "  -invgrid: Instead of solving each reverse gridshift iteratively, build an\n"
+        "    inverse of the gridshift file once, so that each point only needs one\n"
+        "    interpolation.  The inverse is saved next to the GSB file (with the\n"
+        "    extension .GSI) if that folder is writable, and reused on later runs\n"
+        "    until the GSB file changes.  The largest difference from the iterative\n"
+        "    method is reported; it is normally a few millimetres or less.\n"
+        "  -chaingrid: When converting between NAD27 and ATS77, combine the two\n"
+        "    gridshifts (through NAD83) into one grid, so that each point only needs\n"
+        "    one interpolation.  The combined grid covers the area where both\n"
+        "    gridshift files overlap; points outside it are shifted in two steps as\n"
+        "    usual.  It is saved next to the ATS77 GSB file (with the extension\n"
+        "    .NAD27.GSC or .ATS77.GSC, for the source datum) if that folder is\n"
+        "    writable, and reused on later runs until either GSB file changes.  The\n"
+        "    largest difference from the two-step method is reported.\n"
+        "  -quantgrid{=mm}: Keep the gridshifts in memory as scaled integers, where\n"
+        "    that is accurate to within the given distance (1mm by default), which\n"
+        "    takes a half (32 bits) or a quarter (16 bits) of the memory.  Parts of\n"
+        "    the grid that can't be stored that accurately are kept as they are.\n"
+        "    The whole grid is read and quantized when it is opened, and the file's\n"
+        "    records are then released.  With -verbose, the number of parts stored\n"
+        "    each way is reported; at 1mm, many grids need 32 bits.\n"
+        "  -sharegrid: Share the grids built by -invgrid and -chaingrid with other\n"
+        "    copies of SHPTRANS running at the same time, through shared memory, so\n"
+        "    that the first one to need a grid prepares it and the rest use it as-is.\n"
+        "    This saves memory and time when many conversions are run in parallel.\n"
+        "    The GSB files themselves are not shared this way; each copy still reads\n"
+        "    them.  On Linux and other POSIX systems the shared grids stay in memory\n"
+        "    until the system restarts (as /dev/shm/shptrans-* on Linux, which may\n"
+        "    be deleted at any time), and are replaced when a GSB file changes.\n"
+        "  -kruger: Compute Transverse Mercator and UTM coordinates with the Kruger\n"
+        "    series instead of the USGS series, in both directions, with no iteration.\n"
+        "    The result stays accurate to well under a millimetre even far outside the\n"
+        "    zone, where the USGS series drifts by metres, and reverse projection is\n"
+        "    about twice as fast.  Between two TM, UTM or MTM zones on the same datum,\n"
+        "    this converts directly from one zone to the other, which is faster still.\n"
+        "  -fast: For previews and map tiles, project in single precision, with twice\n"
+        "    as many points per SIMD instruction, and skip the terms and iterations\n"
+        "    that only matter below a millimetre.  The error grows with the distance\n"
+        "    from the central meridian or origin, and is at most about 0.04m across\n"
+        "    an MTM zone, 0.09m across a UTM zone, and 0.11m within 200km of the\n"
+        "    origin of a Double Stereographic projection (0.25m at 400km).  The\n"
+        "    output is still written in double precision.  Unless -tolerance is\n"
+        "    also given, reverse gridshifts stop within a millimetre.  This does not\n"
+        "    apply to Transverse Mercator with -kruger, nor to anything with -nosimd.\n"
+        "  -surrogate{=distance}: For dense layers such as parcels and contours,\n"
+        "    replace the whole transformation, projections and gridshifts together,\n"
+        "    with polynomials fitted over tiles of the shapefile's extent.  Each\n"
+        "    tile is checked against the exact transformation at test points across\n"
+        "    it, and divided into smaller tiles where it is out by more than the\n"
+        "    given distance (0.001 by default), in the output units (or in meters,\n"
+        "    if the output is lat/long).  A gridshift has a kink at the edge of each\n"
+        "    of its cells, so tiles that cross one are divided too, and the points\n"
+        "    near the edges are transformed exactly.  Where the data is dense enough,\n"
+        "    this is several times faster; where it is sparse, fitting the tiles can\n"
+        "    cost more than it saves.  With -verbose, the number of tiles and the\n"
+        "    largest error found at the test points are reported.\n"
+        "  -helmert=tx,ty,tz,rx,ry,rz,ppm{,px,py,pz}: Shift the points that are\n"
+        "    outside the gridshift coverage (offshore, or over the border) by this\n"
+        "    Helmert transformation from the 'from' datum to the 'to' datum, instead\n"
+        "    of leaving them unshifted.  The translations are in meters, the\n"
+        "    rotations in arc-seconds (position vector convention; for parameters\n"
+        "    published in the coordinate frame convention, change the sign of the\n"
+        "    rotations) and the scale in parts per million.  If a pivot point\n"
+        "    px,py,pz is given (earth-centred, in meters), the rotation and scale\n"
+        "    are about it (Molodensky-Badekas).  Expect an accuracy of a meter or\n"
+        "    so, depending on the parameters; the gridshift is used wherever it\n"
+        "    covers.  With -verbose, the number of points shifted this way is\n"
+        "    reported.\n"
+        "  -gridfree: With -helmert, shift every point by the Helmert\n"
+        "    transformation, and don't use the gridshift files at all.\n"
+        "  -memolat: For layers vectorised from rasters or graticules, where many\n"
+        "    vertices share a latitude (or a northing, for reverse projection),\n"
+        "    remember the Transverse Mercator terms for recent latitudes and\n"
+        "    northings, and reuse them for the next point on the same row.  The\n"
+        "    results are exactly the same.  This is for older processors, or\n"
+        "    for use with -nosimd; the SSE2, AVX2 and AVX-512 versions of the\n"
+        "    projection are faster than this even on such data, so they are used\n"
+        "    where they can be, and only the last few points of each call go\n"
+        "    through the memo.  It does not apply with -kruger.  With -verbose,\n"
+        "    the hits and misses are reported.\n"
+        "  -nosimd: Don't use the SSE2, AVX2 or AVX-512 versions of the projections,\n"
+        "    even if the processor supports them.  The results differ from the\n"
+        "    ordinary versions only in the last few digits.\n"
         "  -verbose: Provide extra diagnostic information, useful for testing.  Some\n"
-        "    non-fatal transformation errors may be reported with this option selected.\n"
+        "    non-fatal transformation errors may be reported with this option selected,\n"
+        "    along with iteration counts for reverse projections and gridshifts.\n"
         ,file);
     }
 }
@@ -455,14 +570,31 @@ HANDLE dbf_thread = NULL;
 GridShift gs_nad27, gs_ats77;
 DoubleStereographic ds[2];
 TransverseMercator tm[2];
+WebMercator wm[2];
 NullProjection nullProj;
 
 ProjectionBase *prj[2] = { NULL, NULL };
 GridShift *gs[2] = { NULL, NULL };
+ChainedShift gs_chain;
+ChainSurrogate surrogate;
+HelmertShift helmert;
+
+// chosen by setup_coordsys, for apply_transform
+TransformStages stages;
+transform_fn transform = NULL;
 
 int inPlace = 0;
 int changed = 0;
 int verbose = 0;
+int inverseGrid = 0;
+int chainGrid = 0;
+double quantGrid = 0; // mm
+double solverTolerance = 0; // output units
+int fastTier = 0;
+double surrogateTol = 0; // output units
+double helmertParams[10];
+int helmertCount = 0;
+int gridFree = 0;
 
 
 volatile bool userAbort = false;
@@ -540,16 +672,44 @@ void normalize_path(char *fname) {
 
 
 
-shptrans_err open_gridshift_file(GridShift &gs, char *envVarName, char *gsbFilenames) {
+// Find and open a gridshift file.  If mosaic is set, every file that
+// is found is opened, and they are searched as one grid.  The search 
+// order (the environment variable, then the list of filenames in each 
+// folder) is also the priority where the grids overlap.  The variable
+// may also hold a list of files, separated by semicolons.
+
+shptrans_err open_gridshift_file(GridShift &gs, char *envVarName, char *gsbFilenames, int mosaic = 0) {
 
     char *envFile = getenv(envVarName);
+    int nloaded = 0;
 
     if ( envFile ) {
         if (err_none == gs.open(envFile)) return err_none;
+
+        if (mosaic && strchr(envFile, ';')) {
+            char fname[MAX_PATH];
+            char *envPart = envFile;
+            while (*envPart) {
+                int len = strcspn(envPart, ";");
+                if (len && (len < sizeof(fname))) {
+                    memcpy(fname, envPart, len);
+                    fname[len] = '\0';
+                    if (0 == gs.attach(fname)) {
+                        if (verbose) printf("  Using gridshift file %s\n", fname);
+                        ++nloaded;
+                    }
+                }
+                envPart += len;
+                if (*envPart) ++envPart;
+            }
+            if (nloaded) return err_none;
+        }
     }
 
     if (gsbFilenames) {
 
+        unsigned long loadedMask = 0; // which of gsbFilenames are open already
+
         enum { lookInEnvVar, lookInAppDir, lookInArcDir };
 
         for (int placeToLook = 0; placeToLook < 3 ; ++placeToLook) {
@@ -585,28 +745,30 @@ shptrans_err open_gridshift_file(GridShift &gs, char *envVarName, char *gsbFilen
             }
 
             if (filepart) {
-                char *gsbFile;
-                char *gsbToken;
-
-                gsbFile = gsbFilenames;
-                while ( (gsbToken = strchr(gsbFile,':')) ) {
-                    if ((gsbToken > gsbFile) && ((filepart - fname) + (gsbToken-gsbFile) < sizeof(fname)) ) {
-                        memcpy(filepart, gsbFile, gsbToken-gsbFile);
-                        filepart[gsbToken-gsbFile] = '\0';
-                        if (0 == gs.open(fname)) return err_none;
+                char *gsbFile = gsbFilenames;
+
+                for (int token = 0; *gsbFile; ++token) {
+                    int len = strcspn(gsbFile, ":");
+                    if (len && !(loadedMask & (1UL << token)) && ((filepart - fname) + len < sizeof(fname)) ) {
+                        memcpy(filepart, gsbFile, len);
+                        filepart[len] = '\0';
+                        if (0 == gs.attach(fname)) {
+                            if (!mosaic) return err_none;
+                            if (verbose) printf("  Using gridshift file %s\n", fname);
+                            loadedMask |= (1UL << token);
+                            ++nloaded;
+                        }
                     }
-                    gsbFile = gsbToken+1;
-                }
-
-                if (*gsbFile && ((filepart - fname) + strlen(gsbFile) < sizeof(fname)) ) {
-                    strcpy(filepart, gsbFile);
-                    if (0 == gs.open(fname)) return err_none;
+                    gsbFile += len;
+                    if (*gsbFile) ++gsbFile;
                 }
             }
 
         }
     }
 
+    if (nloaded) return err_none;
+
     print_error("Environment variable not set, or GSB file not found: %%%s%%\n",envVarName);
     return err_gshift;
 }
@@ -700,6 +862,61 @@ int main(int argc, char **argv) {
         } else if (!strcmpi(argv[i],"-verbose")) {
             verbose = 1;
 
+        } else if (!strcmpi(argv[i],"-invgrid")) {
+            inverseGrid = 1;
+
+        } else if (!strcmpi(argv[i],"-chaingrid")) {
+            chainGrid = 1;
+
+        } else if (!strcmpi(argv[i],"-quantgrid")) {
+            quantGrid = 1;
+
+        } else if (!strncmpi(argv[i],"-quantgrid=",11)) {
+            quantGrid = atof(argv[i] + 11);
+            if (quantGrid <= 0) {
+                showusage(stderr); showusage(errfile); return err_usage;
+            }
+
+        } else if (!strcmpi(argv[i],"-sharegrid")) {
+            GridShift::shareFields = true;
+
+        } else if (!strcmpi(argv[i],"-kruger")) {
+            TransverseMercator::useKruger = true;
+
+        } else if (!strncmpi(argv[i],"-helmert=",9)) {
+            double *p = helmertParams;
+            helmertCount = sscanf(argv[i] + 9, "%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf",
+              p, p+1, p+2, p+3, p+4, p+5, p+6, p+7, p+8, p+9);
+            if (helmertCount != 7 && helmertCount != 10) {
+                showusage(stderr); showusage(errfile); return err_usage;
+            }
+
+        } else if (!strcmpi(argv[i],"-gridfree")) {
+            gridFree = 1;
+
+        } else if (!strcmpi(argv[i],"-memolat")) {
+            TransverseMercator::memoLatitude = true;
+
+        } else if (!strcmpi(argv[i],"-nosimd")) {
+            ProjectionBase::useSIMD = false;
+
+        } else if (!strcmpi(argv[i],"-fast")) {
+            fastTier = 1;
+
+        } else if (!strcmpi(argv[i],"-surrogate")) {
+            surrogateTol = 0.001;
+
+        } else if (!strncmpi(argv[i],"-surrogate=",11)) {
+            surrogateTol = atof(argv[i] + 11);
+            if (surrogateTol <= 0) {
+                showusage(stderr); showusage(errfile); return err_usage;
+            }
+
+        } else if (!strncmpi(argv[i],"-tolerance=",11)) {
+            solverTolerance = atof(argv[i] + 11);
+            if (solverTolerance <= 0) {
+                showusage(stderr); showusage(errfile); return err_usage;
+            }
 
         } else if (argv[i][0] == '-') {
             showusage(stderr); showusage(errfile); return err_usage;
@@ -741,6 +958,7 @@ int main(int argc, char **argv) {
     //if (fromOff || toOff) { showusage(stderr); return 1; } // overriding offsets not yet supported.
 
     if (!(fromCS && toCS)) { showusage(stderr); showusage(errfile); return 1; }
+    if (gridFree && !helmertCount) { showusage(stderr); showusage(errfile); return 1; }
     if (!(*fromShp && *toShp)) { showusage(stderr); showusage(errfile); return 1; }
 
     normalize_path(fromShp);
@@ -759,6 +977,47 @@ int main(int argc, char **argv) {
 
     errcode = apply_transform(fromShp, toShp);
 
+    if (verbose && ProjectionBase::solverPoints) {
+        printf("Reverse projection: %ld points, %.2f Newton steps per point (max %d),\n"
+          "  largest error left %.6fmm.\n",
+          ProjectionBase::solverPoints,
+          (double)ProjectionBase::solverIterations / ProjectionBase::solverPoints,
+          ProjectionBase::solverMaxIterations,
+          ProjectionBase::solverMaxError * 1000);
+    }
+
+    if (verbose && TransverseMercator::memoLatitude) {
+        long lookups = TransverseMercator::memoHits + TransverseMercator::memoMisses;
+        // With SIMD, only the few points each call leaves over from
+        // the kernels go through the memo.
+        printf("Latitude memo: %ld hits, %ld misses (%.1f%% hits)%s.\n",
+          TransverseMercator::memoHits, TransverseMercator::memoMisses,
+          lookups ? 100.0 * TransverseMercator::memoHits / lookups : 0.0,
+          (ProjectionBase::simdLevel() == SIMD_NONE) ? "" : ",\n  of the points left over from the SIMD versions only");
+    }
+
+    if (verbose && HelmertShift::points) {
+        printf("Helmert transformation: %ld points.\n", HelmertShift::points);
+    }
+
+    if (verbose && stages.surrogate) {
+        printf("Surrogate: %ld tiles fitted, %ld left to the exact transformation;\n"
+          "  %ld points interpolated, %ld transformed exactly; largest error at\n"
+          "  the test points %.9f, in the output units.\n",
+          surrogate.getFittedTiles(), surrogate.getExactTiles(),
+          surrogate.getFittedPoints(), surrogate.getExactPoints(),
+          surrogate.getMaxError());
+    }
+
+    if (verbose && GridShift::reversePoints) {
+        printf("Reverse grid shift: %ld points, %.2f Newton steps per point (max %d),\n"
+          "  largest error left %.9f\" (about %.6fmm).\n",
+          GridShift::reversePoints,
+          (double)GridShift::reverseIterations / GridShift::reversePoints,
+          GridShift::reverseMaxIterations,
+          GridShift::reverseMaxError, GridShift::reverseMaxError * 30870);
+    }
+
     if (errcode) {
         if (shp) fclose(shp);
         if (shx) fclose(shx);
@@ -871,6 +1130,7 @@ shptrans_err setup_coordsys(
     char * scale[2] = { fromScale, toScale };
 
     bool is_peids[2] = {false, false};
+    bool is_tiles[2] = {false, false};
 
     char * from_to[2] = { "from", "to" };
     char * From_To[2] = { "From", "To" };
@@ -940,6 +1200,16 @@ shptrans_err setup_coordsys(
                 printf("%s Transverse Mercator (central meridian %.2f)", From_To[i], centralMeridian);
                 prj[i] = tm+i;
             }
+        } else if (0==strcmpi(prjstr[i],"webmerc")) {
+            printf("%s Web Mercator", From_To[i]);
+            prj[i] = wm+i;
+        } else if (0==strncmpi(prjstr[i],"tile",4)) {
+            zone = atoi(prjstr[i]+4);
+            if (isdigit(prjstr[i][4]) && 0 == wm[i].setTileZoom(zone)) {
+                printf("%s Web Mercator tile pixels (zoom %d)", From_To[i], zone);
+                prj[i] = wm+i;
+                is_tiles[i] = true;
+            }
         } else if (0==strncmpi(prjstr[i],"geo",3)) {
             printf("%s Geographic", From_To[i]);
             prj[i] = &nullProj;
@@ -979,6 +1249,11 @@ shptrans_err setup_coordsys(
             return err_params;
         }
 
+        if (is_tiles[i] && (units[i] || offset[i] || scale[i])) {
+            print_error("Error: Units, offsets and scale cannot be overridden for tile pixels.");
+            return err_params;
+        }
+
         unitFact = 1;
         if (units[i]) {
             if (prj[i] == &nullProj) {
@@ -1053,6 +1328,32 @@ shptrans_err setup_coordsys(
         }
     }
 
+    if (solverTolerance > 0 || fastTier) {
+        // The tolerance is in the output units; the projections take it
+        // in meters, and the gridshifts in arc-seconds (one second of
+        // latitude is about 30.87m).  -fast has no use for more than
+        // a millimetre.
+        double meters = 0.001;
+        if (solverTolerance > 0) {
+            meters = solverTolerance;
+            if (is_tiles[1]) meters /= wm[1].getScaleFactor();
+            else if (prj[1] != &nullProj) meters *= meters_per_unit(units[1]);
+        }
+        ProjectionBase::tolerance = meters;
+        GridShift::tolerance = meters / 30.87;
+    }
+
+    if (helmertCount && gs[0] != gs[1]) {
+        helmert.setParameters(helmertParams, (helmertCount == 10) ? helmertParams + 7 : NULL);
+        helmert.setSpheroids(prj[0]->getAxis(), prj[0]->getFlattening(),
+          prj[1]->getAxis(), prj[1]->getFlattening());
+        stages.helmert = &helmert;
+        if (gridFree) {
+            puts("  Using the Helmert transformation in place of the gridshift.");
+            gs[0] = gs[1] = NULL;
+        }
+    }
+
     if (gs[0] == gs[1]) {
         gs[0] = gs[1] = NULL;
     } else {
@@ -1060,7 +1361,7 @@ shptrans_err setup_coordsys(
 
         if (gs[0] == &gs_ats77 || gs[1] == &gs_ats77) {
             errcode = open_gridshift_file(gs_ats77, "SHPTRANS_GRIDSHIFT_7783",
-              "NB7783V2.GSB:NS7783V2.GSB:NS778301.GSB:PE7783V2.GSB:GS7783.GSB");
+              "NB7783V2.GSB:NS7783V2.GSB:NS778301.GSB:PE7783V2.GSB:GS7783.GSB", 1);
             if (errcode != err_none) return errcode;
         }
 
@@ -1069,6 +1370,131 @@ shptrans_err setup_coordsys(
               "NTV2_0.GSB:MAY76V20.GSB");
             if (errcode != err_none) return errcode;
         }
+
+        if (quantGrid > 0) {
+            // one second of latitude is about 30.87m; a second of
+            // longitude is less, so this is within quantGrid mm.
+            for (int g = 0; g < 2; ++g) {
+                int counts[3];
+                if (!gs[g]) continue;
+                if (GRID_OK != gs[g]->quantize(quantGrid / 30870, counts)) continue;
+                if (verbose) {
+                    printf("  Quantized %s: %d subgrids in 16 bits, %d in 32 bits, %d as is.\n",
+                      gs[g]->getFileName(), counts[0], counts[1], counts[2]);
+                }
+            }
+        }
+
+        if (inverseGrid && gs[1]) {
+            char cacheFile[MAX_PATH] = "";
+            if (strlen(gs[1]->getFileName()) + 4 < sizeof(cacheFile)) {
+                strcpy(cacheFile, gs[1]->getFileName());
+                swapext(cacheFile, "gsi");
+            }
+
+            puts("Preparing inverse grid for reverse gridshift.");
+            if (GRID_OK != gs[1]->buildInverse(*cacheFile ? cacheFile : NULL)) {
+                print_error("Error: Not enough memory for the inverse grid.");
+                return err_mem;
+            }
+
+            // one second of latitude is about 30.87m
+            printf("  Largest difference from iterative method: %.7f\" (about %.2fmm)\n",
+              gs[1]->getInverseError(), gs[1]->getInverseError() * 30870);
+        }
+
+        if (chainGrid && gs[0] && gs[1]) {
+            // The ATS77 grids are much finer than NTv2, so the
+            // composed grid uses their nodes.
+            char cacheFile[MAX_PATH] = "";
+            if (strlen(gs_ats77.getFileName()) + 10 < sizeof(cacheFile)) {
+                strcpy(cacheFile, gs_ats77.getFileName());
+                swapext(cacheFile, (gs[0] == &gs_nad27) ? "nad27.gsc" : "ats77.gsc");
+            }
+
+            puts("Preparing composed grid for NAD27 to/from ATS77.");
+            if (GRID_OK != gs_chain.build(*gs[0], *gs[1], gs_ats77, *cacheFile ? cacheFile : NULL)) {
+                print_error("Error: Not enough memory for the composed grid.");
+                return err_mem;
+            }
+
+            printf("  Largest difference from two-step method: %.7f\" (about %.2fmm)\n",
+              gs_chain.getError(), gs_chain.getError() * 30870);
+        }
+    }
+
+    // Pick the pipeline for this combination of stages, once.
+    int kind[2];
+    for (i = 0; i < 2; ++i) {
+        kind[i] = (prj[i] == tm+i) ? PIPE_TM : (prj[i] == ds+i) ? PIPE_DS
+          : (prj[i] == wm+i) ? PIPE_WM : PIPE_GEO;
+    }
+
+    int datum = (gridFree && stages.helmert) ? PIPE_DATUM_HELMERT
+      : gs_chain.ready() ? PIPE_DATUM_CHAINED
+      : gs[0] ? (gs[1] ? PIPE_DATUM_BOTH : PIPE_DATUM_FORWARD)
+      : gs[1] ? PIPE_DATUM_REVERSE : PIPE_DATUM_NONE;
+
+    stages.from = prj[0];
+    stages.to = prj[1];
+    stages.forward = gs[0];
+    stages.reverse = gs[1];
+    stages.chain = &gs_chain;
+    transform = select_transform(kind[0], kind[1], datum, fastTier != 0);
+
+    // If only the offsets, scale or units change, the projection
+    // needn't be undone and redone at all.
+    bool sameSpheroid = (datum == PIPE_DATUM_NONE)
+      && (prj[0]->getAxis() == prj[1]->getAxis())
+      && (prj[0]->getFlattening() == prj[1]->getFlattening());
+    bool sameProjection = sameSpheroid && (kind[0] == kind[1]);
+
+    if (sameProjection && kind[0] == PIPE_TM) {
+        sameProjection = (tm[0].getCentralMeridian() == tm[1].getCentralMeridian());
+    } else if (sameProjection && kind[0] == PIPE_DS) {
+        sameProjection = (ds[0].getOriginLongitude() == ds[1].getOriginLongitude())
+          && (ds[0].getOriginLatitude() == ds[1].getOriginLatitude());
+    } else if (sameProjection && kind[0] == PIPE_WM) {
+        // tile pixels are whole, so not linear in meters
+        sameProjection = (wm[0].getTileZoom() == wm[1].getTileZoom());
+    }
+
+    if (sameProjection) {
+        if (kind[0] == PIPE_GEO) {
+            stages.scale = 1;
+            stages.offsetX = stages.offsetY = 0;
+        } else {
+            stages.scale = prj[1]->getScaleFactor() / prj[0]->getScaleFactor();
+            stages.offsetX = prj[1]->getFalseEasting() - prj[0]->getFalseEasting() * stages.scale;
+            stages.offsetY = prj[1]->getFalseNorthing() - prj[0]->getFalseNorthing() * stages.scale;
+        }
+
+        if (stages.scale == 1 && stages.offsetX == 0 && stages.offsetY == 0) {
+            puts("  Same coordinate system; coordinates will be copied as they are.");
+            transform = transform_copy;
+        } else {
+            puts("  Same projection and datum; only offsets and scale will be applied.");
+            transform = transform_affine;
+        }
+
+    } else if (sameSpheroid && kind[0] == PIPE_TM && kind[1] == PIPE_TM && TransverseMercator::useKruger) {
+        // With the Kruger series, one zone can be projected straight
+        // to another, skipping latitude and longitude.
+        puts("  Same datum; converting directly between zones.");
+        transform = transform_tm_zone;
+    }
+
+    if (surrogateTol > 0 && transform != transform_copy && transform != transform_affine && !is_tiles[1]) {
+        // The tolerance is in the output units, or in meters for
+        // lat/long; a degree of latitude is about 111.32km, and a
+        // degree of longitude no more.  (Not for tile pixels, which
+        // go in whole steps that the polynomials can't follow.)
+        double tolerance = surrogateTol;
+        if (prj[1] == &nullProj) tolerance /= 111320;
+
+        surrogate.open(transform, stages, tolerance);
+        stages.surrogate = &surrogate;
+        transform = transform_surrogate;
     }
 
     return err_none;
@@ -1233,30 +1659,6 @@ float UpdateStatus(float percentDone) {
 
 
 
-inline void expand_box(double *box, double *xy, int count) {
-    double *px, *py;
-
-    while (count--) {
-        px = xy++; py = xy++;
-
-        if (*px < box[0]) box[0] = *px;
-        if (*px > box[2]) box[2] = *px;
-
-        if (*py < box[1]) box[1] = *py;
-        if (*py > box[3]) box[3] = *py;
-    }
-}
-
-inline void init_box(double *box, double *xy, int count) {
-    box[2] = box[0] = xy[0];
-    box[1] = box[3] = xy[1];
-    if (count > 1) {
-        expand_box(box, xy+2,count-1);
-    }
-}
-
-
-
 inline void rescale_coordinates(double factor, double *xy, int count) {
     count *=2;
     while (count--) {
@@ -1287,9 +1689,11 @@ shptrans_err apply_transform(char *fromShp, char *toShp) {
 
     long *pRec = 0;
     unsigned long recLen, recPos;
-    double *pPts = 0, *pPtsOrig=0;
+    double *pPts = 0;
+    double *pX, *pY;
     double *pBox = 0;
     double recBox[4];
+    double recLLBox[4];
     double totalBox[4];
 
     float percentDone = 0;
@@ -1301,9 +1705,8 @@ shptrans_err apply_transform(char *fromShp, char *toShp) {
 
     long errCount = 0;
 
-#if FORCE_ALIGN
-    pod_array<double,2> coordBuf(1024);
-#endif
+    // the record's points, as the pipeline takes them
+    soa_array coords(1024);
 
     long recno = 0;
     long shpType = 0;
@@ -1370,6 +1773,13 @@ shptrans_err apply_transform(char *fromShp, char *toShp) {
     if (!shx) return err_create;
     if ((100!=fread(shxHead,1,100,shx))) return err_magic;
 
+    // -surrogate covers the extent in the header (the same as the SHP's)
+    if (stages.surrogate) {
+        double extent[4];
+        memcpy(extent, shxHead + 36, 32);
+        stages.surrogate->setExtent(extent);
+    }
+
     if (inPlace) {
         shxOut = shx;
     } else {
@@ -1431,7 +1841,7 @@ shptrans_err apply_transform(char *fromShp, char *toShp) {
 
         shpType = pRec[2]; // SHP type and data are in Intel order
 
-        pBox = pPts = pPtsOrig = NULL;
+        pBox = pPts = NULL;
 
         if (shpType < 30) {
            switch (shpType % 10) {
@@ -1461,11 +1871,6 @@ shptrans_err apply_transform(char *fromShp, char *toShp) {
         if (pPts) {
 
 #     if FORCE_ALIGN
-           if ( ((unsigned long)pPts) & 7) {
-               pPtsOrig = pPts;
-               pPts = coordBuf.reserve(numPts);
-               memcpy(pPts, pPtsOrig, numPts*16);
-           }
            if ( ((unsigned long)pBox) & 7) {
                memcpy(recBox, pBox, 32); //0 is aligned so no null test
                pBox = recBox;
@@ -1475,26 +1880,43 @@ shptrans_err apply_transform(char *fromShp, char *toShp) {
            //NEED TO BYTESWAP COORDS HERE TO COMPLETE THE
            //BIG-ENDIAN PORT.
 
-           // apply transformations (fn namesake)
-
-           tran_err = prj[0]->toLatLong(pPts, numPts);
+           // Separate the x and y of the points, for the pipeline
+           // (this also takes care of their alignment).
+           if (!coords.reserve(numPts)) return err_mem;
+           pX = coords.x();
+           pY = coords.y();
+           soa_split(pPts, pX, pY, numPts);
+
+           // For a larger record, start loading the grid nodes it
+           // will need into the cache, judging by the corners of its
+           // box, so that this overlaps with unprojecting the record.
+           if (pBox && (numPts > 8) && (gs[0] || gs[1])) {
+               double corners[8] = {
+                   pBox[0], pBox[1],  pBox[2], pBox[1],
+                   pBox[0], pBox[3],  pBox[2], pBox[3]
+               };
+               if (!prj[0]->toLatLong(corners, 4)) {
+                   init_box(recLLBox, corners, 4);
+                   if (gs_chain.ready()) {
+                       gs_chain.prefetch(recLLBox);
+                   } else {
+                       if (gs[0]) gs[0]->prefetch(recLLBox);
+                       if (gs[1]) gs[1]->prefetch(recLLBox);
+                   }
+               }
+           }
 
-           if (!tran_err) {
-               tran_err = (gs[0] && gs[0]->forward(pPts, numPts)) ||
-                          (gs[1] && gs[1]->reverse(pPts, numPts));
+           // apply transformations (fn namesake), and find the
+           // record's new extent along the way
 
-                         //fromLatLong first to avoid short-circuit
-               tran_err = prj[1]->fromLatLong(pPts, numPts) || tran_err;
-           }
+           tran_err = transform(stages, pX, pY, numPts, pBox);
 
            if (tran_err && verbose) {
                print_error("\nSHPTRANS: Error in record %d.",i+1);
            }
 
            if (pBox) {
-               //update this record's bounding box
-               //as well as the shapefile's bbox
-               init_box(pBox, pPts, numPts);
+               //update the shapefile's bbox from this record's
                if (totalPts) {
                    expand_box(totalBox, pBox, 2);
                } else {
@@ -1510,17 +1932,14 @@ shptrans_err apply_transform(char *fromShp, char *toShp) {
                // e.g. a simple point record.
                //just update the shp header
                if (totalPts) {
-                   expand_box(totalBox, pPts, numPts);
+                   expand_box(totalBox, pX, pY, numPts);
                } else {
-                   init_box(totalBox, pPts, numPts);
+                   init_box(totalBox, pX, pY, numPts);
                }
            }
 
-#if FORCE_ALIGN
-           if (pPtsOrig) {
-               memcpy(pPts, pPtsOrig, numPts*16);
-           }
-#endif
+           // and back into the record
+           soa_join(pX, pY, pPts, numPts);
 
            totalPts += numPts;
            changed=1;
@@ -44,6 +44,9 @@
 **/
 
 
+// Scalar helpers, for the ordinary versions of the projections and
+// whatever the SIMD kernels leave over; those use vecmath.h.
+
 #include <math.h>
 
 #ifndef PI
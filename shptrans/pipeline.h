@@ -0,0 +1,335 @@
+/** 
+ * pipeline.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  The transformation applied to each record, as one function per 
+  combination of source projection, datum step and target projection.
+  setup_coordsys picks the instantiation of transform_tiles once, so
+  the stages are called directly (non-virtually, and inline for a 
+  geographic end) and the datum step is fixed at compile time.
+  
+  Points are pushed through every stage a tile at a time, small
+  enough to stay in the L1 cache throughout, rather than each stage
+  making its own pass over a large record.
+  
+  With Fast, the projections are called through their -fast tier
+  (fromLatLongFast and toLatLongFast) instead.
+  
+  The points come as separate arrays of x and of y (split from the
+  record when it is read, and joined again when it is written; see
+  soa_array), so every stage's SIMD kernel loads whole vectors of x
+  and of y with no shuffling.
+*/
+
+#ifndef _PIPELINE_H
+#define _PIPELINE_H
+
+#include "projbase.h"
+#include "tmerc.h"
+#include "dstereo.h"
+#include "webmerc.h"
+#include "gshift.h"
+#include "helmert.h"
+
+inline void expand_box(double *box, double *xy, int count) {
+    double *px, *py;
+
+    while (count--) {
+        px = xy++; py = xy++;
+
+        if (*px < box[0]) box[0] = *px;
+        if (*px > box[2]) box[2] = *px;
+
+        if (*py < box[1]) box[1] = *py;
+        if (*py > box[3]) box[3] = *py;
+    }
+}
+
+inline void init_box(double *box, double *xy, int count) {
+    box[2] = box[0] = xy[0];
+    box[1] = box[3] = xy[1];
+    if (count > 1) {
+        expand_box(box, xy+2,count-1);
+    }
+}
+
+// the same, for separate arrays of x and y
+inline void expand_box(double *box, double const *x, double const *y, long count) {
+    for (long i = 0; i < count; ++i) {
+        if (x[i] < box[0]) box[0] = x[i];
+        if (x[i] > box[2]) box[2] = x[i];
+
+        if (y[i] < box[1]) box[1] = y[i];
+        if (y[i] > box[3]) box[3] = y[i];
+    }
+}
+
+inline void init_box(double *box, double const *x, double const *y, long count) {
+    box[2] = box[0] = x[0];
+    box[1] = box[3] = y[0];
+    if (count > 1) {
+        expand_box(box, x+1, y+1, count-1);
+    }
+}
+
+// kinds of projection, for select_transform
+enum {
+    PIPE_GEO,           // NullProjection
+    PIPE_TM,            // TransverseMercator
+    PIPE_DS,            // DoubleStereographic
+    PIPE_WM             // WebMercator
+};
+
+// how the datum is changed, between unprojecting and reprojecting
+enum {
+    PIPE_DATUM_NONE,
+    PIPE_DATUM_FORWARD, // forward shift by one grid
+    PIPE_DATUM_REVERSE, // reverse shift by one grid
+    PIPE_DATUM_BOTH,    // forward by one grid, then reverse by another
+    PIPE_DATUM_CHAINED, // the same, composed into one ChainedShift
+    PIPE_DATUM_HELMERT  // by HelmertShift, with no grid
+};
+
+class ChainSurrogate;
+
+struct TransformStages {
+    ProjectionBase *from;
+    ProjectionBase *to;
+    GridShift *forward;
+    GridShift *reverse;
+    ChainedShift *chain;
+    
+    // If set, for the points where the gridshift fails (see
+    // shift_fallback), or for PIPE_DATUM_HELMERT.
+    HelmertShift *helmert;
+    
+    // for transform_affine: x' = x * scale + offsetX, and so on
+    double scale;
+    double offsetX, offsetY;
+    
+    // for transform_surrogate (see surrogate.h)
+    ChainSurrogate *surrogate;
+};
+
+const int transformTile = 256;
+
+// Shift n points one at a time from saved (the tile as it was before
+// the datum step) into x,y, by the gridshifts where they can and by 
+// the Helmert transformation where they can't.
+inline int shift_fallback(TransformStages const &stages, int datum, double *x, double *y, 
+        double const *savedX, double const *savedY, int n) {
+    int tran_err = 0;
+    
+    for (int i = 0; i < n; ++i) {
+        int err = 0;
+        double xy[2] = { savedX[i], savedY[i] };
+        
+        if (datum == PIPE_DATUM_CHAINED) {
+            err = stages.chain->apply(xy, 1);
+        } else {
+            if (datum != PIPE_DATUM_REVERSE) err = stages.forward->forward(xy, 1);
+            if (datum != PIPE_DATUM_FORWARD && !err) err = stages.reverse->reverse(xy, 1);
+        }
+        
+        if (err) {
+            xy[0] = savedX[i];
+            xy[1] = savedY[i];
+            err = stages.helmert->forward(xy, 1);
+        }
+        
+        x[i] = xy[0];
+        y[i] = xy[1];
+        tran_err = tran_err || err;
+    }
+    
+    return tran_err;
+}
+
+// Unproject, shift and reproject count points in place, and set box
+// (if given) to their extent afterwards.  Returns nonzero if any 
+// stage failed.
+template <class From, class To, int Datum, bool Fast>
+int transform_tiles(TransformStages const &stages, double *x, double *y, long count, double *box) {
+    From *from = static_cast<From*>(stages.from);
+    To *to = static_cast<To*>(stages.to);
+    
+    int tran_err = 0;
+    double llBox[4];
+    double savedX[transformTile], savedY[transformTile];
+    
+    for (long done = 0; done < count; done += transformTile, x += transformTile, y += transformTile) {
+        int n = (count - done < transformTile) ? (int)(count - done) : transformTile;
+        
+        int err = Fast ? from->From::toLatLongFast(x, y, n) : from->From::toLatLong(x, y, n);
+        
+        if (!err) {
+            if (Datum == PIPE_DATUM_HELMERT) {
+                err = stages.helmert->forward(x, y, n);
+            } else if (Datum != PIPE_DATUM_NONE) {
+                // With the tile's extent, the gridshift can tell if 
+                // the whole tile is in one subgrid.
+                init_box(llBox, x, y, n);
+                
+                if (stages.helmert) {
+                    for (int i = 0; i < n; ++i) {
+                        savedX[i] = x[i];
+                        savedY[i] = y[i];
+                    }
+                }
+                
+                if (Datum == PIPE_DATUM_CHAINED) {
+                    err = stages.chain->apply(x, y, n, llBox);
+                } else {
+                    if (Datum != PIPE_DATUM_REVERSE) {
+                        err = stages.forward->forward(x, y, n, llBox);
+                    }
+                    if (Datum != PIPE_DATUM_FORWARD && !err) {
+                        if (Datum == PIPE_DATUM_BOTH) init_box(llBox, x, y, n);
+                        err = stages.reverse->reverse(x, y, n, llBox);
+                    }
+                }
+                
+                // Off the grid, or partly so: go back over the tile.
+                if (err && stages.helmert) {
+                    err = shift_fallback(stages, Datum, x, y, savedX, savedY, n);
+                }
+            }
+            
+                      //fromLatLong first to avoid short-circuit
+            err = (Fast ? to->To::fromLatLongFast(x, y, n) : to->To::fromLatLong(x, y, n)) || err;
+        }
+        
+        tran_err = tran_err || err;
+        
+        if (box) {
+            if (done) {
+                expand_box(box, x, y, n);
+            } else {
+                init_box(box, x, y, n);
+            }
+        }
+    }
+    
+    return tran_err;
+}
+
+// Where the source and target are the same projection on the same
+// datum, and differ only in false offsets and scale factor (which 
+// is also how units are applied), projecting is linear in both, so
+// the whole transformation comes down to this.
+inline int transform_affine(TransformStages const &stages, double *x, double *y, long count, double *box) {
+    const double scale = stages.scale;
+    const double offsetX = stages.offsetX, offsetY = stages.offsetY;
+    
+    for (long i = 0; i < count; ++i) {
+        x[i] = x[i] * scale + offsetX;
+        y[i] = y[i] * scale + offsetY;
+    }
+    
+    if (box && count) init_box(box, x, y, count);
+    return 0;
+}
+
+// ... and where they are identical, to nothing at all.
+inline int transform_copy(TransformStages const &, double *x, double *y, long count, double *box) {
+    if (box && count) init_box(box, x, y, count);
+    return 0;
+}
+
+// Between Transverse Mercator zones on the same spheroid, with the 
+// Kruger series; see TransverseMercator::toZone.
+inline int transform_tm_zone(TransformStages const &stages, double *x, double *y, long count, double *box) {
+    TransverseMercator *from = static_cast<TransverseMercator*>(stages.from);
+    TransverseMercator *to = static_cast<TransverseMercator*>(stages.to);
+    
+    int err = from->toZone(*to, x, y, count);
+    
+    if (box && count) init_box(box, x, y, count);
+    return err;
+}
+
+typedef int (*transform_fn)(TransformStages const &stages, double *x, double *y, long count, double *box);
+
+template <class From, class To, bool Fast>
+transform_fn select_transform_datum(int datum) {
+    switch (datum) {
+      case PIPE_DATUM_FORWARD: return transform_tiles<From, To, PIPE_DATUM_FORWARD, Fast>;
+      case PIPE_DATUM_REVERSE: return transform_tiles<From, To, PIPE_DATUM_REVERSE, Fast>;
+      case PIPE_DATUM_BOTH:    return transform_tiles<From, To, PIPE_DATUM_BOTH, Fast>;
+      case PIPE_DATUM_CHAINED: return transform_tiles<From, To, PIPE_DATUM_CHAINED, Fast>;
+      case PIPE_DATUM_HELMERT: return transform_tiles<From, To, PIPE_DATUM_HELMERT, Fast>;
+      default:                 return transform_tiles<From, To, PIPE_DATUM_NONE, Fast>;
+    }
+}
+
+template <class From, bool Fast>
+transform_fn select_transform_to(int to, int datum) {
+    switch (to) {
+      case PIPE_TM: return select_transform_datum<From, TransverseMercator, Fast>(datum);
+      case PIPE_DS: return select_transform_datum<From, DoubleStereographic, Fast>(datum);
+      case PIPE_WM: return select_transform_datum<From, WebMercator, Fast>(datum);
+      default:      return select_transform_datum<From, NullProjection, Fast>(datum);
+    }
+}
+
+template <bool Fast>
+transform_fn select_transform_from(int from, int to, int datum) {
+    switch (from) {
+      case PIPE_TM: return select_transform_to<TransverseMercator, Fast>(to, datum);
+      case PIPE_DS: return select_transform_to<DoubleStereographic, Fast>(to, datum);
+      case PIPE_WM: return select_transform_to<WebMercator, Fast>(to, datum);
+      default:      return select_transform_to<NullProjection, Fast>(to, datum);
+    }
+}
+
+// the pipeline for these kinds of projection and datum step, and tier
+inline transform_fn select_transform(int from, int to, int datum, bool fast = false) {
+    return fast ? select_transform_from<true>(from, to, datum)
+                : select_transform_from<false>(from, to, datum);
+}
+
+#endif
@@ -54,6 +54,8 @@
 extern "C" {
     typedef unsigned size_t;
     void *realloc(void*, size_t);
+    void *malloc(size_t);
+    void free(void*);
 }
 
 template <class elt_t, unsigned ncolumns> class pod_array {
@@ -125,5 +127,45 @@ elt_t const * pod_array<elt_t,ncolumns>::operator[](size_t offset) const {
     return (elt_t const *)(pArray + (offset * (ncolumns?ncolumns:1)));
 }
 
+
+// soa_array holds points as two arrays, all the x and then all the y,
+// as the transform pipeline takes them (see pipeline.h); a record's
+// interleaved points are split into it, and joined back, by soa_split
+// and soa_join.  Unlike pod_array, growing it doesn't keep the points.
+class soa_array {
+  public:
+    soa_array(size_t sz = 0):pArray(0),size(0) { reserve(sz); }
+    ~soa_array() { free(pArray); }
+  
+    int reserve(size_t need_size);
+    size_t storage() const { return size; }
+    
+    double *x() { return pArray; }
+    double *y() { return pArray + size; }
+  private:
+    double* pArray;
+    size_t size;
+  
+    //not implemented:
+    soa_array(const soa_array&);
+    void operator=(const soa_array&);
+};
+
+inline int soa_array::reserve(size_t needsize) {
+    if (needsize>size) {
+        // a whole number of cache lines each, so y starts on one 
+        // wherever x does
+        size_t newsize = (size+1)*2;
+        while (needsize>newsize) newsize *=2;
+        newsize = (newsize + 7) & ~7u;
+        
+        free(pArray);
+        pArray = (double*)malloc(newsize * 2 * sizeof(double));
+        size = pArray ? newsize : 0;
+        return pArray != 0;
+    }
+    return 1;
+}
+
 #endif
 
@@ -47,8 +47,114 @@
 
 #include "projbase.h"
 
+#include <string.h>
+
 const double ProjectionBase::epsilon = 2.0E-12;
 bool ProjectionBase::highPrecision = false;
+bool ProjectionBase::useSIMD = true;
+double ProjectionBase::tolerance = 0;
+
+long ProjectionBase::solverPoints = 0;
+long ProjectionBase::solverIterations = 0;
+int ProjectionBase::solverMaxIterations = 0;
+double ProjectionBase::solverMaxError = 0;
+
+int ProjectionBase::simdLevel() {
+#ifdef HAVE_SIMD_KERNELS
+   static int level = -1;
+   if (level < 0) {
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f")) level = SIMD_AVX512;
+      else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) level = SIMD_AVX2;
+      else if (__builtin_cpu_supports("sse2")) level = SIMD_SSE2;
+      else level = SIMD_NONE;
+   }
+   return useSIMD ? level : SIMD_NONE;
+#else
+   return SIMD_NONE;
+#endif
+}
+
+#ifdef HAVE_SIMD_KERNELS
+// soavec.h; each does a multiple of its width, and returns how many
+long soa_splitSSE2(double const *xy, double *x, double *y, long count);
+long soa_splitAVX2(double const *xy, double *x, double *y, long count);
+long soa_splitAVX512(double const *xy, double *x, double *y, long count);
+long soa_joinSSE2(double const *x, double const *y, double *xy, long count);
+long soa_joinAVX2(double const *x, double const *y, double *xy, long count);
+long soa_joinAVX512(double const *x, double const *y, double *xy, long count);
+#endif
+
+void soa_split(double const *xy, double *x, double *y, long count) {
+   long done = 0;
+#ifdef HAVE_SIMD_KERNELS
+   switch (ProjectionBase::simdLevel()) {
+     case SIMD_AVX512: done = soa_splitAVX512(xy, x, y, count); break;
+     case SIMD_AVX2: done = soa_splitAVX2(xy, x, y, count); break;
+     case SIMD_SSE2: done = soa_splitSSE2(xy, x, y, count); break;
+   }
+#endif
+   // byte-wise, as a record's points needn't be aligned (FORCE_ALIGN)
+   for (long i = done; i < count; ++i) {
+      memcpy(x + i, xy + 2*i, sizeof(double));
+      memcpy(y + i, xy + 2*i + 1, sizeof(double));
+   }
+}
+
+void soa_join(double const *x, double const *y, double *xy, long count) {
+   long done = 0;
+#ifdef HAVE_SIMD_KERNELS
+   switch (ProjectionBase::simdLevel()) {
+     case SIMD_AVX512: done = soa_joinAVX512(x, y, xy, count); break;
+     case SIMD_AVX2: done = soa_joinAVX2(x, y, xy, count); break;
+     case SIMD_SSE2: done = soa_joinSSE2(x, y, xy, count); break;
+   }
+#endif
+   for (long i = done; i < count; ++i) {
+      memcpy(xy + 2*i, x + i, sizeof(double));
+      memcpy(xy + 2*i + 1, y + i, sizeof(double));
+   }
+}
+
+// For separate arrays, through the interleaved versions, a tile at
+// a time on the stack.
+const int soaTile = 64;
+
+int ProjectionBase::fromLatLong(double *x, double *y, int count) {
+   double xy[2 * soaTile];
+   int err = PROJ_SUCCESS;
+   
+   for (int done = 0; done < count; done += soaTile) {
+      int n = (count - done < soaTile) ? count - done : soaTile;
+      soa_join(x + done, y + done, xy, n);
+      int e = fromLatLong(xy, n);
+      if (e) err = e;
+      soa_split(xy, x + done, y + done, n);
+   }
+   return err;
+}
+
+int ProjectionBase::toLatLong(double *x, double *y, int count) {
+   double xy[2 * soaTile];
+   int err = PROJ_SUCCESS;
+   
+   for (int done = 0; done < count; done += soaTile) {
+      int n = (count - done < soaTile) ? count - done : soaTile;
+      soa_join(x + done, y + done, xy, n);
+      int e = toLatLong(xy, n);
+      if (e) err = e;
+      soa_split(xy, x + done, y + done, n);
+   }
+   return err;
+}
+
+void ProjectionBase::addSolverStats(long count, long steps, int maxSteps, double maxError) {
+   if (count <= 0) return;
+   solverPoints += count;
+   solverIterations += steps;
+   if (maxSteps > solverMaxIterations) solverMaxIterations = maxSteps;
+   if (maxError * a > solverMaxError) solverMaxError = maxError * a;
+}
 
 int ProjectionBase::setSpheroid(double axis, double flattening) {
    if (axis <= 0 || flattening <= 0) return PROJ_E_SPHEROID;
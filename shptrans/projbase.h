@@ -57,12 +57,57 @@ enum {
  PROJ_E_OTHER
 };
 
+// SIMD kernels are built with GCC vector extensions, for x86
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define HAVE_SIMD_KERNELS
+#endif
+
+enum {
+ SIMD_NONE=0,
+ SIMD_SSE2,        // 2 doubles
+ SIMD_AVX2,        // 4 doubles, with FMA
+ SIMD_AVX512       // 8 doubles
+};
+
+// Where a SIMD kernel finds its points: interleaved x,y pairs, as
+// in a shapefile record, or separate arrays of x and of y, as the 
+// transform pipeline keeps them (see soa_array).  The kernels are
+// templates on these, and load from either with no copying.
+struct PointPairs {
+   double *xy;
+   PointPairs(double *xy): xy(xy) {}
+};
+
+struct PointArrays {
+   double *x, *y;
+   PointArrays(double *x, double *y): x(x), y(y) {}
+};
+
+// Separate arrays from interleaved pairs, and back, by the widest
+// SIMD kernel there is (soavec.h); for record decode and encode.
+void soa_split(double const *xy, double *x, double *y, long count);
+void soa_join(double const *x, double const *y, double *xy, long count);
+
 class ProjectionBase {
 protected:
    virtual int spheroidChanged() { return PROJ_SUCCESS; }
 public:
    virtual int fromLatLong(double *xy, int count) = 0;
    virtual int toLatLong(double *xy, int count) = 0;
+   
+   // The -fast tier: the same, in single precision where the projection
+   // has kernels for it (see tmvec.h and dsvec.h), to within about 0.1m.
+   virtual int fromLatLongFast(double *xy, int count) { return fromLatLong(xy, count); }
+   virtual int toLatLongFast(double *xy, int count) { return toLatLong(xy, count); }
+   
+   // All of the above, for separate arrays of x and y.  By default
+   // these go through the interleaved versions a tile at a time; the
+   // projections with kernels run them on the arrays directly, and 
+   // leave only the last few points to this.
+   virtual int fromLatLong(double *x, double *y, int count);
+   virtual int toLatLong(double *x, double *y, int count);
+   virtual int fromLatLongFast(double *x, double *y, int count) { return fromLatLong(x, y, count); }
+   virtual int toLatLongFast(double *x, double *y, int count) { return toLatLong(x, y, count); }
 
    int setSpheroid(double axis, double flattening);
    double getAxis() { return a; }
@@ -83,6 +128,21 @@ public:
                                 // might have dynamic resources
 
    static bool highPrecision;
+   
+   // Where to stop the iterative reverse projections, as a distance in
+   // metres; 0 for the fixed defaults (see highPrecision).
+   static double tolerance;
+   
+   // iterative solver statistics, for -verbose
+   static long solverPoints;       // points solved iteratively
+   static long solverIterations;   // Newton steps taken, in total
+   static int solverMaxIterations; // most Newton steps for any point
+   static double solverMaxError;   // largest error left, in metres
+   
+   // Whether to use the SIMD kernels, where the projection has them,
+   // and the widest kind this CPU can run (SIMD_NONE if useSIMD is off).
+   static bool useSIMD;
+   static int simdLevel();
 
 protected:
    double a;                    // semi-major axis
@@ -92,12 +152,27 @@ protected:
    double k0;                   // scale factor
 
    static const double epsilon;
+   
+   // Add to the solver statistics: count points took steps Newton steps
+   // in all, at most maxSteps for one, leaving at most maxError radians.
+   void addSolverStats(long count, long steps, int maxSteps, double maxError);
+   
+   // The tolerance as an angle on this spheroid, in radians.
+   double angularTolerance() const {
+      return (tolerance > 0) ? tolerance / a : (highPrecision ? epsilon / 100000 : epsilon);
+   }
 };
 
 class NullProjection : public ProjectionBase {
 public:
    int fromLatLong(double *,int) { return 0; }
    int toLatLong(double *, int) { return 0; }
+   int fromLatLongFast(double *,int) { return 0; }
+   int toLatLongFast(double *, int) { return 0; }
+   int fromLatLong(double *, double *, int) { return 0; }
+   int toLatLong(double *, double *, int) { return 0; }
+   int fromLatLongFast(double *, double *, int) { return 0; }
+   int toLatLongFast(double *, double *, int) { return 0; }
 protected:
    int spheroidChanged();
 };
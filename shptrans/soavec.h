@@ -0,0 +1,106 @@
+/** 
+ * soavec.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  Interleaved x,y pairs to separate arrays of x and y, and back, for
+  VEC_WIDTH points at a time; included by sse2.cpp, avx2.cpp and 
+  avx512.cpp in the same way as tmvec.h, for soa_split and soa_join
+  (projbase.cpp).  Unlike vec_load_xy, these keep the points in 
+  order, which takes a permute across lanes for AVX2 and AVX-512.
+*/
+
+#include "projbase.h"
+#include "vecmath.h"
+
+#if VEC_WIDTH == 2
+static const vlong soa_even = { 0, 2 };
+static const vlong soa_odd = { 1, 3 };
+static const vlong soa_lo = { 0, 2 };
+static const vlong soa_hi = { 1, 3 };
+#elif VEC_WIDTH == 4
+static const vlong soa_even = { 0, 2, 4, 6 };
+static const vlong soa_odd = { 1, 3, 5, 7 };
+static const vlong soa_lo = { 0, 4, 1, 5 };
+static const vlong soa_hi = { 2, 6, 3, 7 };
+#else
+static const vlong soa_even = { 0, 2, 4, 6, 8, 10, 12, 14 };
+static const vlong soa_odd = { 1, 3, 5, 7, 9, 11, 13, 15 };
+static const vlong soa_lo = { 0, 8, 1, 9, 2, 10, 3, 11 };
+static const vlong soa_hi = { 4, 12, 5, 13, 6, 14, 7, 15 };
+#endif
+
+long VEC_NAME(soa_split)(double const *xy, double *x, double *y, long count) {
+    long done = count - count % VEC_WIDTH;
+    
+    for (long i = 0; i < done; i += VEC_WIDTH) {
+        vdouble lo, hi;
+        memcpy(&lo, xy + 2*i, sizeof lo);
+        memcpy(&hi, xy + 2*i + VEC_WIDTH, sizeof hi);
+        vdouble vx = __builtin_shuffle(lo, hi, soa_even);
+        vdouble vy = __builtin_shuffle(lo, hi, soa_odd);
+        memcpy(x + i, &vx, sizeof vx);
+        memcpy(y + i, &vy, sizeof vy);
+    }
+    
+    return done;
+}
+
+long VEC_NAME(soa_join)(double const *x, double const *y, double *xy, long count) {
+    long done = count - count % VEC_WIDTH;
+    
+    for (long i = 0; i < done; i += VEC_WIDTH) {
+        vdouble vx, vy;
+        memcpy(&vx, x + i, sizeof vx);
+        memcpy(&vy, y + i, sizeof vy);
+        vdouble lo = __builtin_shuffle(vx, vy, soa_lo);
+        vdouble hi = __builtin_shuffle(vx, vy, soa_hi);
+        memcpy(xy + 2*i, &lo, sizeof lo);
+        memcpy(xy + 2*i + VEC_WIDTH, &hi, sizeof hi);
+    }
+    
+    return done;
+}
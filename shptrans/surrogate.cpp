@@ -0,0 +1,386 @@
+/** 
+ * surrogate.cpp - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+#include "surrogate.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "math87.h"
+
+// The polynomial is fitted at fitNodes^2 Chebyshev nodes, and
+// checked on a lattice of testNodes^2 points.
+const int fitNodes = surrogateDegree + 1;
+const int testNodes = 9;
+const int samplePoints = fitNodes * fitNodes + testNodes * testNodes;
+
+// how many exact points a tile that failed takes before it is split
+const long splitCost = 4 * samplePoints;
+
+
+static void init_tile(SurrogateTile &tile, double x0, double y0, double x1, double y1, int depth) {
+    tile.x0 = x0; tile.y0 = y0;
+    tile.x1 = x1; tile.y1 = y1;
+    tile.state = ChainSurrogate::tile_unfitted;
+    tile.depth = depth;
+    tile.child = -1;
+    tile.exactCount = 0;
+    tile.cx = (x0 + x1) / 2;
+    tile.cy = (y0 + y1) / 2;
+    tile.sx = 2 / (x1 - x0);
+    tile.sy = 2 / (y1 - y0);
+}
+
+static inline bool in_tile(SurrogateTile const &tile, double x, double y) {
+    return x >= tile.x0 && x <= tile.x1 && y >= tile.y0 && y <= tile.y1;
+}
+
+// Evaluate both of tile's polynomials at x,y: the powers of v first,
+// then the sum over j for each power of u, then Horner's scheme in u.
+static inline void eval_tile(SurrogateTile const &tile, double *x, double *y) {
+    const int n = surrogateDegree + 1;
+    double u = (*x - tile.cx) * tile.sx;
+    double v = (*y - tile.cy) * tile.sy;
+    
+    double vp[n];
+    vp[0] = 1;
+    for (int j = 1; j < n; ++j) vp[j] = vp[j-1] * v;
+    
+    double sumX = 0, sumY = 0;
+    for (int i = n - 1; i >= 0; --i) {
+        double const *rowX = tile.coef[0] + i * n;
+        double const *rowY = tile.coef[1] + i * n;
+        double rx = 0, ry = 0;
+        for (int j = 0; j < n; ++j) {
+            rx += rowX[j] * vp[j];
+            ry += rowY[j] * vp[j];
+        }
+        sumX = sumX * u + rx;
+        sumY = sumY * u + ry;
+    }
+    
+    *x = sumX;
+    *y = sumY;
+}
+
+
+void ChainSurrogate::resetStats() {
+    fittedTiles = exactTiles = 0;
+    fittedPoints = exactPoints = 0;
+    maxError = 0;
+}
+
+void ChainSurrogate::open(transform_fn fn, TransformStages const &s, double tol) {
+    close();
+    exact = fn;
+    stages = s;
+    tolerance = tol;
+}
+
+void ChainSurrogate::close() {
+    if (tiles) free(tiles);
+    tiles = 0;
+    numTiles = capacity = 0;
+    hint = -1;
+}
+
+int ChainSurrogate::setExtent(double const *box) {
+    close();
+    
+    // An empty or degenerate extent has nothing to fit to.
+    if (!exact || !(box[2] > box[0] && box[3] > box[1])) return 0;
+    
+    tiles = (SurrogateTile*) malloc(64 * sizeof(SurrogateTile));
+    if (!tiles) return 0;
+    capacity = 64;
+    numTiles = 1;
+    init_tile(tiles[0], box[0], box[1], box[2], box[3], 0);
+    return 1;
+}
+
+
+// Divide tile t (which failed) in four, unless it is as small as it
+// may get.
+int ChainSurrogate::split_tile(long t) {
+    if (tiles[t].depth >= surrogateMaxDepth) return 0;
+    if (numTiles + 4 > surrogateMaxTiles) return 0;
+    
+    if (numTiles + 4 > capacity) {
+        long newCapacity = capacity * 2;
+        if (newCapacity > surrogateMaxTiles) newCapacity = surrogateMaxTiles;
+        SurrogateTile *newTiles = (SurrogateTile*) realloc(tiles, newCapacity * sizeof(SurrogateTile));
+        if (!newTiles) return 0;
+        tiles = newTiles;
+        capacity = newCapacity;
+    }
+    
+    SurrogateTile &tile = tiles[t];
+    SurrogateTile *child = tiles + numTiles;
+    
+    // in the order find_tile expects: x first, then y
+    init_tile(child[0], tile.x0, tile.y0, tile.cx, tile.cy, tile.depth + 1);
+    init_tile(child[1], tile.cx, tile.y0, tile.x1, tile.cy, tile.depth + 1);
+    init_tile(child[2], tile.x0, tile.cy, tile.cx, tile.y1, tile.depth + 1);
+    init_tile(child[3], tile.cx, tile.cy, tile.x1, tile.y1, tile.depth + 1);
+    
+    tile.child = numTiles;
+    tile.state = tile_split;
+    numTiles += 4;
+    --exactTiles;
+    return 1;
+}
+
+
+// Whether each gridshift is bilinear over the whole of the test 
+// lattice (n points x,y, in source coordinates): that is, whether it 
+// falls in one cell of each grid, or entirely off it.  A reverse
+// shift is bilinear where its result is, so that is what counts.
+int ChainSurrogate::one_cell(double const *x, double const *y, int n) {
+    double llX[testNodes * testNodes], llY[testNodes * testNodes];
+    int first[6], key[6];
+    int i, k;
+    
+    memcpy(llX, x, n * sizeof(double));
+    memcpy(llY, y, n * sizeof(double));
+    if (stages.from->toLatLong(llX, llY, n)) return 0;
+    
+    for (i = 0; i < n; ++i) {
+        double p[2] = { llX[i], llY[i] };
+        for (k = 0; k < 6; ++k) key[k] = -1;
+        
+        if (stages.chain && stages.chain->ready()) stages.chain->findCell(p, key);
+        if (stages.forward) {
+            stages.forward->findCell(p, key + 2);
+            stages.forward->forward(p, 1);
+        }
+        if (stages.reverse) {
+            stages.reverse->reverse(p, 1);
+            stages.reverse->findCell(p, key + 4);
+        }
+        
+        if (i == 0) {
+            memcpy(first, key, sizeof(first));
+        } else if (memcmp(first, key, sizeof(first))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+void ChainSurrogate::fit_tile(long t) {
+    SurrogateTile &tile = tiles[t];
+    
+    double node[fitNodes];
+    double x[samplePoints], y[samplePoints];
+    double *nodeX = x, *testX = x + fitNodes * fitNodes;
+    double *nodeY = y, *testY = y + fitNodes * fitNodes;
+    int i, j, a, b, k;
+    
+    // the Chebyshev nodes, and the test lattice (edges and all)
+    for (i = 0; i < fitNodes; ++i) {
+        node[i] = cos(PI * (2 * i + 1) / (2 * fitNodes));
+    }
+    for (i = 0; i < fitNodes; ++i) {
+        for (j = 0; j < fitNodes; ++j) {
+            nodeX[i * fitNodes + j] = tile.cx + node[i] / tile.sx;
+            nodeY[i * fitNodes + j] = tile.cy + node[j] / tile.sy;
+        }
+    }
+    for (i = 0; i < testNodes; ++i) {
+        double tx = (i == testNodes - 1) ? tile.x1 : tile.x0 + (tile.x1 - tile.x0) * i / (testNodes - 1);
+        for (j = 0; j < testNodes; ++j) {
+            double ty = (j == testNodes - 1) ? tile.y1 : tile.y0 + (tile.y1 - tile.y0) * j / (testNodes - 1);
+            testX[i * testNodes + j] = tx;
+            testY[i * testNodes + j] = ty;
+        }
+    }
+    
+    double testInX[testNodes * testNodes], testInY[testNodes * testNodes];
+    for (i = 0; i < testNodes * testNodes; ++i) {
+        testInX[i] = testX[i];
+        testInY[i] = testY[i];
+    }
+    
+    // Across the edge of a gridshift cell or subgrid, or of the grid
+    // itself, the transformation has a kink or a step, which no 
+    // polynomial follows; and the test points could miss it.
+    if (one_cell(testInX, testInY, testNodes * testNodes) && !exact(stages, x, y, samplePoints, 0)) {
+        // cheb[a][m] is the coefficient of T_a(u) at node m, and 
+        // power[a][p] that of u^p in T_a(u).
+        double cheb[fitNodes][fitNodes];
+        double power[fitNodes][fitNodes];
+        
+        for (a = 0; a < fitNodes; ++a) {
+            for (i = 0; i < fitNodes; ++i) {
+                cheb[a][i] = cos(a * PI * (2 * i + 1) / (2 * fitNodes)) * (a ? 2.0 : 1.0) / fitNodes;
+                power[a][i] = 0;
+            }
+        }
+        power[0][0] = 1;
+        power[1][1] = 1;
+        for (a = 2; a < fitNodes; ++a) {
+            for (i = 0; i < fitNodes; ++i) {
+                power[a][i] = (i ? 2 * power[a-1][i-1] : 0) - power[a-2][i];
+            }
+        }
+        
+        for (k = 0; k < 2; ++k) {
+            // Chebyshev coefficients, by discrete orthogonality at the
+            // nodes, then converted to powers of u and v.
+            double const *nodeK = k ? nodeY : nodeX;
+            double c[fitNodes][fitNodes];
+            for (a = 0; a < fitNodes; ++a) {
+                for (b = 0; b < fitNodes; ++b) {
+                    double sum = 0;
+                    for (i = 0; i < fitNodes; ++i) {
+                        for (j = 0; j < fitNodes; ++j) {
+                            sum += nodeK[i * fitNodes + j] * cheb[a][i] * cheb[b][j];
+                        }
+                    }
+                    c[a][b] = sum;
+                }
+            }
+            
+            for (i = 0; i < fitNodes; ++i) {
+                for (j = 0; j < fitNodes; ++j) {
+                    double sum = 0;
+                    for (a = i; a < fitNodes; ++a) {
+                        for (b = j; b < fitNodes; ++b) {
+                            sum += c[a][b] * power[a][i] * power[b][j];
+                        }
+                    }
+                    tile.coef[k][i * fitNodes + j] = sum;
+                }
+            }
+        }
+        
+        // Check it; a NaN anywhere counts as a failure.
+        double worst = 0;
+        for (i = 0; i < testNodes * testNodes; ++i) {
+            eval_tile(tile, testInX + i, testInY + i);
+            double dx = fabs(testInX[i] - testX[i]);
+            double dy = fabs(testInY[i] - testY[i]);
+            if (!(dx <= worst)) worst = dx;
+            if (!(dy <= worst)) worst = dy;
+        }
+        
+        if (worst <= tolerance / 4) {
+            tile.state = tile_fitted;
+            ++fittedTiles;
+            if (worst > maxError) maxError = worst;
+            return;
+        }
+    }
+    
+    tile.state = tile_exact;
+    ++exactTiles;
+}
+
+
+// The leaf tile containing x,y, fitting tiles on the way as need be;
+// or -1 if it is outside the extent.
+long ChainSurrogate::find_tile(double x, double y) {
+    if (!numTiles || !in_tile(tiles[0], x, y)) return -1;
+    
+    long t = 0;
+    for (;;) {
+        if (tiles[t].state == tile_unfitted) fit_tile(t);
+        if (tiles[t].state != tile_split) return t;
+        
+        SurrogateTile const &tile = tiles[t];
+        t = tile.child + (x >= tile.cx) + 2 * (y >= tile.cy);
+    }
+}
+
+
+int ChainSurrogate::apply(double *x, double *y, long count) {
+    if (!numTiles) {
+        exactPoints += count;
+        return exact(stages, x, y, count, 0);
+    }
+    
+    int err = 0;
+    long i = 0;
+    
+    while (i < count) {
+        long t = hint;
+        if (t < 0 || !in_tile(tiles[t], x[i], y[i])) {
+            hint = t = find_tile(x[i], y[i]);
+        }
+        
+        if (t >= 0 && tiles[t].state == tile_fitted) {
+            // the run of points in the same tile
+            SurrogateTile const &tile = tiles[t];
+            long first = i;
+            do {
+                eval_tile(tile, x + i, y + i);
+                ++i;
+            } while (i < count && in_tile(tile, x[i], y[i]));
+            fittedPoints += i - first;
+        } else if (t >= 0) {
+            // the run of points in the same tile, up to the point 
+            // where it is time to split it
+            SurrogateTile &tile = tiles[t];
+            long first = i;
+            do {
+                ++i;
+                ++tile.exactCount;
+            } while (i < count && tile.exactCount < splitCost && in_tile(tile, x[i], y[i]));
+            
+            err = exact(stages, x + first, y + first, i - first, 0) || err;
+            exactPoints += i - first;
+            
+            if (tile.exactCount >= splitCost && split_tile(t)) hint = -1;
+        } else {
+            err = exact(stages, x + i, y + i, 1, 0) || err;
+            ++exactPoints;
+            ++i;
+        }
+    }
+    
+    return err;
+}
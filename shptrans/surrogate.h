@@ -0,0 +1,159 @@
+/** 
+ * surrogate.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+/*
+  A stand-in for the whole transformation, for dense data.  Between
+  the source coordinates and the target coordinates, unprojecting, 
+  shifting and reprojecting is a smooth function of the input, so
+  over a small enough area it is matched closely by a polynomial.
+  
+  The extent of the shapefile is divided into tiles, as a quadtree,
+  and each tile gets a polynomial of degree surrogateDegree in x and
+  y when the first point falls in it.
+  
+  The gridshifts interpolate bilinearly within each cell of the grid,
+  so they are only smooth within a cell: at the edges of cells and
+  subgrids, and of the grid itself, there is a kink or a step.  A tile
+  is only fitted if its test points (below) lie in one cell of each
+  grid, or all off it; so the gridshift is a single bilinear function
+  throughout, and the whole transformation is smooth.
+  
+  The polynomial is fitted at Chebyshev nodes through the exact 
+  transformation, and then checked against it on a lattice of test 
+  points across the tile, edges and corners included.  If any test
+  point is out by more than a quarter of the tolerance (leaving room
+  for whatever lies between them), or the tile crosses a cell, or the
+  exact transformation fails, the tile's points are transformed
+  exactly; once there have been as many of those as it would take to
+  fit its four quarters, the tile is split and the quarters tried in
+  turn.  So splitting follows the density of the data, down to tiles
+  within single cells, and the tiles along the edges of cells cost no
+  more than twice what the exact transformation would.
+*/
+
+#ifndef _SURROGATE_H
+#define _SURROGATE_H
+
+#include "pipeline.h"
+
+const int surrogateDegree = 5;
+const int surrogateTerms = (surrogateDegree + 1) * (surrogateDegree + 1);
+const int surrogateMaxDepth = 16;
+const long surrogateMaxTiles = 32768;
+
+struct SurrogateTile {
+    double x0, y0, x1, y1;     // extent, in source coordinates
+    int state;                 // see ChainSurrogate::tile_state
+    int depth;
+    long child;                // first of four quarters, once split
+    long exactCount;           // points transformed exactly, once failed
+    double cx, cy, sx, sy;     // u = (x - cx) * sx, v = (y - cy) * sy
+    double coef[2][surrogateTerms]; // of u^i v^j, at [i * (degree+1) + j]
+};
+
+class ChainSurrogate {
+  public:
+    enum tile_state {
+      tile_unfitted, tile_fitted, tile_exact, tile_split
+    };
+    
+    ChainSurrogate(): tiles(0), numTiles(0), capacity(0), hint(-1), exact(0), tolerance(0) { resetStats(); }
+    ~ChainSurrogate() { close(); }
+    
+    // Stand in for exact, with the given stages, to within tolerance
+    // (in the target coordinates).  Call setExtent before apply.
+    void open(transform_fn exact, TransformStages const &stages, double tolerance);
+    void close();
+    
+    // The area to cover, as xmin, ymin, xmax, ymax in the source
+    // coordinates.  Points outside it are transformed exactly.
+    int setExtent(double const *box);
+    bool ready() const { return numTiles != 0; }
+    
+    // Transform count points x,y in place; nonzero if any failed.
+    int apply(double *x, double *y, long count);
+    
+    // statistics, for -verbose
+    long getFittedTiles() const { return fittedTiles; }
+    long getExactTiles() const { return exactTiles; }
+    long getFittedPoints() const { return fittedPoints; }
+    long getExactPoints() const { return exactPoints; }
+    double getMaxError() const { return maxError; } // at test points
+  
+  protected:
+    SurrogateTile *tiles;
+    long numTiles;
+    long capacity;
+    long hint;                 // the last tile used
+    
+    transform_fn exact;
+    TransformStages stages;
+    double tolerance;
+    
+    long fittedTiles, exactTiles;
+    long fittedPoints, exactPoints;
+    double maxError;
+    
+    void resetStats();
+    long find_tile(double x, double y);
+    void fit_tile(long t);
+    int one_cell(double const *x, double const *y, int n);
+    int split_tile(long t);
+  
+  private:
+    ChainSurrogate(ChainSurrogate&);
+    void operator=(ChainSurrogate&);
+};
+
+// the pipeline for -surrogate; stages.surrogate keeps the exact one
+inline int transform_surrogate(TransformStages const &stages, double *x, double *y, long count, double *box) {
+    int err = stages.surrogate->apply(x, y, count);
+    
+    if (box && count) init_box(box, x, y, count);
+    return err;
+}
+
+#endif
@@ -0,0 +1,182 @@
+/** 
+ * dstest.cpp - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  Checks the Double Stereographic SIMD kernels against the scalar 
+  code, over the NB and PEI extents, in both directions.
+
+    dstest {count}
+  
+  projects count random points (10^6 by default) in each extent, and
+  the origin itself, with ProjectionBase::useSIMD on and then off, and
+  fails if the results differ by more than 2e-8 m forward or 1e-12
+  degrees in reverse.  Short runs of every length up to 17 points,
+  and a long run of odd length starting at an odd point, check that
+  the points the kernels leave to the scalar code are done.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "dstereo.h"
+#include "testutil.h"
+
+static const double axis = 6378137, flattening = 1 / 298.257222101;
+
+// Project count points both ways, from ll, and return the largest
+// differences between the SIMD and scalar results.
+static void compare(
+    DoubleStereographic &ds, double const *ll, long count, double *work,
+    double *fwdDiff, double *invDiff, double *tSimd, double *tScalar
+) {
+    double *simd = work, *scalar = work + 2 * count;
+    long i;
+    
+    *tSimd = *tScalar = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        double *xy = pass ? scalar : simd;
+        ProjectionBase::useSIMD = (pass == 0);
+        memcpy(xy, ll, 2 * count * sizeof(double));
+        double start = test_seconds();
+        ds.fromLatLong(xy, (int)count);
+        *(pass ? tScalar : tSimd) += test_seconds() - start;
+    }
+    
+    *fwdDiff = 0;
+    for (i = 0; i < 2 * count; ++i) {
+        double d = fabs(simd[i] - scalar[i]);
+        if (!(d <= *fwdDiff)) *fwdDiff = d;
+    }
+    
+    // reverse from the same (scalar) projected points
+    memcpy(simd, scalar, 2 * count * sizeof(double));
+    for (int pass = 0; pass < 2; ++pass) {
+        double *xy = pass ? scalar : simd;
+        ProjectionBase::useSIMD = (pass == 0);
+        double start = test_seconds();
+        ds.toLatLong(xy, (int)count);
+        *(pass ? tScalar : tSimd) += test_seconds() - start;
+    }
+    
+    *invDiff = 0;
+    for (i = 0; i < 2 * count; ++i) {
+        double d = fabs(simd[i] - scalar[i]);
+        if (!(d <= *invDiff)) *invDiff = d;
+    }
+}
+
+int main(int argc, char **argv) {
+    long count = (argc > 1) ? atol(argv[1]) : 1000000L;
+    if (count <= 0) {
+        puts("usage: dstest {count}");
+        return 2;
+    }
+    count |= 1;  // odd, so that there is a tail
+    
+    static const struct {
+        char const *name;
+        double lon0, lat0;      // the origin
+        double box[4];          // min lon, min lat, max lon, max lat
+        double x0, y0;          // false offsets
+    } extents[2] = {
+        { "NB", -66.5, 46.5, { -69.1, 44.5, -63.7, 48.1 }, 2500000, 7500000 },
+        { "PEI", -63.0, 47.25, { -64.5, 45.9, -61.9, 47.1 }, 400000, 800000 },
+    };
+    
+    double *ll = (double*)malloc(6 * (count + 1) * sizeof(double));
+    if (!ll) return 2;
+    double *work = ll + 2 * (count + 1);
+    int failed = 0;
+    
+    printf("SIMD level %d\n", ProjectionBase::simdLevel());
+    for (int e = 0; e < 2; ++e) {
+        DoubleStereographic ds;
+        ds.setSpheroid(axis, flattening);
+        ds.setOrigin(extents[e].lon0, extents[e].lat0);
+        ds.setFalseOffsets(extents[e].x0, extents[e].y0);
+        
+        test_seed(e + 1);
+        for (long i = 0; i < count; ++i) {
+            ll[2*i] = test_random(extents[e].box[0], extents[e].box[2]);
+            ll[2*i+1] = test_random(extents[e].box[1], extents[e].box[3]);
+        }
+        // the origin, which the kernels special-case by lane
+        ll[2*(count/2)] = extents[e].lon0;
+        ll[2*(count/2)+1] = extents[e].lat0;
+        
+        double fwd, inv, tSimd, tScalar;
+        double fwdWorst = 0, invWorst = 0;
+        
+        printf("%s, %ld points:\n", extents[e].name, count);
+        compare(ds, ll, count, work, &fwd, &inv, &tSimd, &tScalar);
+        failed += test_check("forward, SIMD vs scalar", fwd, 2e-8, "m");
+        failed += test_check("reverse, SIMD vs scalar", inv, 1e-12, "deg");
+        printf("  %-40s %8.1f ns SIMD, %8.1f ns scalar\n", "time per point, both ways",
+            tSimd * 1e9 / count, tScalar * 1e9 / count);
+        
+        // the tails: every short length, and a long odd run from an
+        // odd point
+        for (long n = 1; n <= 17; ++n) {
+            compare(ds, ll + 2 * n, n, work, &fwd, &inv, &tSimd, &tScalar);
+            if (fwd > fwdWorst) fwdWorst = fwd;
+            if (inv > invWorst) invWorst = inv;
+        }
+        compare(ds, ll + 2, count - 2, work, &fwd, &inv, &tSimd, &tScalar);
+        if (fwd > fwdWorst) fwdWorst = fwd;
+        if (inv > invWorst) invWorst = inv;
+        failed += test_check("forward, 1 to 17 and odd runs", fwdWorst, 2e-8, "m");
+        failed += test_check("reverse, 1 to 17 and odd runs", invWorst, 1e-12, "deg");
+    }
+    
+    free(ll);
+    if (failed) {
+        printf("dstest: %d checks failed.\n", failed);
+        return 1;
+    }
+    return 0;
+}
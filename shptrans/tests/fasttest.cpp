@@ -0,0 +1,306 @@
+/** 
+ * fasttest.cpp - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  Checks the -fast tier against the double precision path, for each
+  projection it covers, and fails if it is out by more than what the
+  -help text promises.
+
+    fasttest {count {gsbfile}}
+  
+  projects count random points (10^6 by default) with fromLatLongFast
+  and toLatLongFast, as -fast sets them up (ProjectionBase::tolerance
+  at 1 mm), and compares them with fromLatLong and toLatLong at the
+  default tolerance:
+  
+    Transverse Mercator, across MTM zone 5            0.04 m
+    Transverse Mercator, across UTM zone 17, 0-80N    0.09 m
+    Double Stereographic, within 200 km of NB origin   0.11 m
+    Double Stereographic, 200 to 400 km out            0.25 m
+    Transverse Mercator with -kruger, Web Mercator     exact
+  
+  The last two have no single precision path, so they must come back
+  unchanged.  The reverse gridshift, with GridShift::tolerance at 1 mm,
+  is checked against the default over random points in the grid given
+  (or in SHPTRANS_GRIDSHIFT_NTV2), and is skipped if there is none.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tmerc.h"
+#include "dstereo.h"
+#include "webmerc.h"
+#include "gshift.h"
+#include "testutil.h"
+
+static const double axis = 6378137, flattening = 1 / 298.257222101;
+
+// The distance between two lon,lat points (degrees), in metres; 
+// good enough for errors.
+static double ground_error(double const *p, double const *q) {
+    double dy = (p[1] - q[1]) * 111320;
+    double dx = (p[0] - q[0]) * 111320 * cos(p[1] * (PI / 180));
+    return sqrt(dx * dx + dy * dy);
+}
+
+// Project count points from ll both ways, exactly and then with the 
+// Fast calls, and return the largest differences, in metres.
+static void compare(
+    ProjectionBase &prj, double const *ll, long count, double *work,
+    double *fwdDiff, double *invDiff
+) {
+    double *exact = work, *fast = work + 2 * count;
+    long i;
+    
+    ProjectionBase::tolerance = 0;
+    memcpy(exact, ll, 2 * count * sizeof(double));
+    prj.fromLatLong(exact, (int)count);
+    ProjectionBase::tolerance = 0.001;
+    memcpy(fast, ll, 2 * count * sizeof(double));
+    prj.fromLatLongFast(fast, (int)count);
+    
+    *fwdDiff = 0;
+    for (i = 0; i < count; ++i) {
+        double dx = exact[2*i] - fast[2*i], dy = exact[2*i+1] - fast[2*i+1];
+        double d = sqrt(dx * dx + dy * dy);
+        if (!(d <= *fwdDiff)) *fwdDiff = d;
+    }
+    
+    // reverse from the same (exact) projected points
+    memcpy(fast, exact, 2 * count * sizeof(double));
+    ProjectionBase::tolerance = 0;
+    prj.toLatLong(exact, (int)count);
+    ProjectionBase::tolerance = 0.001;
+    prj.toLatLongFast(fast, (int)count);
+    ProjectionBase::tolerance = 0;
+    
+    *invDiff = 0;
+    for (i = 0; i < count; ++i) {
+        double d = ground_error(exact + 2*i, fast + 2*i);
+        if (!(d <= *invDiff)) *invDiff = d;
+    }
+}
+
+// Fill ll with count random points in the box (min lon, min lat, max
+// lon, max lat).  If maxDist is given, only points between minDist and
+// maxDist metres (on the mean sphere) from the box's centre are kept.
+static void random_points(
+    double *ll, long count, double const *box,
+    double minDist = 0, double maxDist = 0
+) {
+    double lon0 = (box[0] + box[2]) / 2, lat0 = (box[1] + box[3]) / 2;
+    double c0 = cos(lat0 * (PI / 180)), s0 = sin(lat0 * (PI / 180));
+    
+    for (long i = 0; i < count; ) {
+        double lon = test_random(box[0], box[2]);
+        double lat = test_random(box[1], box[3]);
+        if (maxDist > 0) {
+            double c = cos(lat * (PI / 180)), s = sin(lat * (PI / 180));
+            double cosd = s0 * s + c0 * c * cos((lon - lon0) * (PI / 180));
+            double d = 6371000 * acos(cosd > 1 ? 1 : cosd);
+            if (d < minDist || d > maxDist) continue;
+        }
+        ll[2*i] = lon;
+        ll[2*i+1] = lat;
+        ++i;
+    }
+}
+
+// A grid's subgrids are only visible to a GridShift.
+class TestGrid: public GridShift {
+  public:
+    // Fill ll with count random points inside the top-level subgrids.
+    int random_points(double *ll, long count) {
+        if (!gridData || gridData->nfiles <= 0) return 0;
+        for (long i = 0; i < count; ++i) {
+            int n = (int)test_random(0, gridData->nfiles);
+            subGridType *sg = &gridData->subGrid[n];
+            while (sg->parent >= 0) sg = &gridData->subGrid[sg->parent];
+            // seconds, positive west; a cell in from the edges, so
+            // that the shifted point is still inside
+            double dy = sg->alimit[4], dx = sg->alimit[5];
+            ll[2*i] = -test_random(sg->alimit[2] + dx, sg->alimit[3] - dx) / 3600;
+            ll[2*i+1] = test_random(sg->alimit[0] + dy, sg->alimit[1] - dy) / 3600;
+        }
+        return 1;
+    }
+};
+
+static int check_gridshift(char *fname, long count, double *ll, double *work) {
+    TestGrid gs;
+    if (!fname || gs.open(fname) != GRID_OK) {
+        printf("gridshift: no GSB file given, skipped\n");
+        return 0;
+    }
+    
+    test_seed(7);
+    gs.random_points(ll, count);
+    printf("gridshift %s, %ld points:\n", fname, count);
+    
+    // shift forward, exactly, so that every point has a reverse
+    double *exact = work, *fast = work + 2 * count;
+    gs.forward(ll, (int)count);
+    memcpy(exact, ll, 2 * count * sizeof(double));
+    memcpy(fast, ll, 2 * count * sizeof(double));
+    
+    GridShift::tolerance = 0;
+    int err = gs.reverse(exact, (int)count);
+    GridShift::tolerance = 0.001 / 30.87;
+    err |= gs.reverse(fast, (int)count);
+    GridShift::tolerance = 0;
+    
+    double worst = 0;
+    for (long i = 0; i < count; ++i) {
+        double d = ground_error(exact + 2*i, fast + 2*i);
+        if (!(d <= worst)) worst = d;
+    }
+    int failed = test_check("reverse, 1 mm tolerance vs default", worst, 0.001, "m");
+    if (err != GRID_OK) {
+        printf("  some points could not be shifted  FAILED\n");
+        ++failed;
+    }
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    long count = (argc > 1) ? atol(argv[1]) : 1000000L;
+    if (count <= 0) {
+        puts("usage: fasttest {count {gsbfile}}");
+        return 2;
+    }
+    char *gsbFile = (argc > 2) ? argv[2] : getenv("SHPTRANS_GRIDSHIFT_NTV2");
+    
+    double *ll = (double*)malloc(6 * count * sizeof(double));
+    if (!ll) return 2;
+    double *work = ll + 2 * count;
+    double fwd, inv;
+    int failed = 0;
+    
+    printf("SIMD level %d\n", ProjectionBase::simdLevel());
+    
+    static const struct {
+        char const *name;
+        int mtm, zone;
+        double box[4];          // min lon, min lat, max lon, max lat
+        double bound;
+    } zones[4] = {
+        { "MTM zone 5", 1, 5, { -66.0, 43.0, -63.0, 49.0 }, 0.04 },
+        { "UTM zone 17, 0-10N", 0, 17, { -84.0, 0.0, -78.0, 10.0 }, 0.09 },
+        { "UTM zone 17, 40-50N", 0, 17, { -84.0, 40.0, -78.0, 50.0 }, 0.09 },
+        { "UTM zone 17, 60-80N", 0, 17, { -84.0, 60.0, -78.0, 80.0 }, 0.09 },
+    };
+    for (int kruger = 0; kruger < 2; ++kruger) {
+        TransverseMercator::useKruger = (kruger != 0);
+        for (int z = 0; z < 4; ++z) {
+            TransverseMercator tm;
+            tm.setSpheroid(axis, flattening);
+            if (zones[z].mtm) PrepareMTM(tm, zones[z].zone);
+            else PrepareUTM(tm, zones[z].zone);
+            
+            test_seed(z + 1);
+            random_points(ll, count, zones[z].box);
+            compare(tm, ll, count, work, &fwd, &inv);
+            
+            // -kruger has no single precision path
+            double bound = kruger ? 0 : zones[z].bound;
+            printf("Transverse Mercator%s, %s, %ld points:\n",
+                kruger ? " (Kruger)" : "", zones[z].name, count);
+            failed += test_check("forward, fast vs double", fwd, bound, "m");
+            failed += test_check("reverse, fast vs double", inv, bound, "m");
+        }
+    }
+    TransverseMercator::useKruger = false;
+    
+    static const struct {
+        double minDist, maxDist;
+        double bound;
+    } rings[2] = {
+        { 0, 200000, 0.11 },
+        { 200000, 400000, 0.25 },
+    };
+    for (int r = 0; r < 2; ++r) {
+        DoubleStereographic ds;
+        ds.setSpheroid(axis, flattening);
+        ds.setOriginNB();
+        ds.setFalseOffsets(2500000, 7500000);
+        
+        // centred on the origin, and wide enough for 400 km
+        static const double box[4] = { -72.0, 42.8, -61.0, 50.2 };
+        test_seed(r + 11);
+        random_points(ll, count, box, rings[r].minDist, rings[r].maxDist);
+        compare(ds, ll, count, work, &fwd, &inv);
+        
+        printf("Double Stereographic, NB, %g to %g km out, %ld points:\n",
+            rings[r].minDist / 1000, rings[r].maxDist / 1000, count);
+        failed += test_check("forward, fast vs double", fwd, rings[r].bound, "m");
+        failed += test_check("reverse, fast vs double", inv, rings[r].bound, "m");
+    }
+    
+    {
+        WebMercator wm;
+        wm.setSpheroid(axis, flattening);
+        static const double box[4] = { -180.0, -85.0, 180.0, 85.0 };
+        test_seed(21);
+        random_points(ll, count, box);
+        compare(wm, ll, count, work, &fwd, &inv);
+        
+        printf("Web Mercator, %ld points:\n", count);
+        failed += test_check("forward, fast vs double", fwd, 0, "m");
+        failed += test_check("reverse, fast vs double", inv, 0, "m");
+    }
+    
+    failed += check_gridshift(gsbFile, count, ll, work);
+    
+    free(ll);
+    if (failed) {
+        printf("fasttest: %d checks failed.\n", failed);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,206 @@
+/** 
+ * krugertest.cpp - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  Compares the Kruger series with the USGS Bulletin 1532 series for
+  Transverse Mercator (-kruger), on GRS80 in UTM zone 20, and times
+  both in each direction, with and without the SIMD kernels.
+
+    krugertest {count}
+  
+  uses count random points (10^6 by default) over the zone, from the
+  equator to 84N, and the same again 9 and 20 degrees off the central
+  meridian.  It fails if the Kruger series' round trip is not within
+  1e-7 m anywhere, if the meridian arc at 80N is not within 1e-6 m
+  of numeric integration, or if the two series differ by more than 
+  3 mm within the zone (the USGS series' error, mostly; its arc is
+  about 1 mm off at 80N).  The USGS series' drift outside the zone is
+  only reported.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tmerc.h"
+#include "testutil.h"
+
+static const double axis = 6378137, flattening = 1 / 298.257222101;
+
+// The distance between two lon,lat points (degrees), in metres; 
+// good enough for errors.
+static double ground_error(double const *p, double const *q) {
+    double dy = (p[1] - q[1]) * 111320;
+    double dx = (p[0] - q[0]) * 111320 * cos(p[1] * (PI / 180));
+    return sqrt(dx * dx + dy * dy);
+}
+
+// The meridian arc from the equator to lat (degrees), by Simpson's 
+// rule in long double.
+static double meridian_arc(double lat) {
+    long double esq = flattening * (2 - flattening);
+    long double phi = lat * (PI / 180), sum = 0;
+    int n = 100000;
+    for (int i = 0; i <= n; ++i) {
+        long double s = sinl(phi * i / n);
+        long double m = axis * (1 - esq) / powl(1 - esq * s * s, 1.5L);
+        sum += m * ((i == 0 || i == n) ? 1 : (i & 1) ? 4 : 2);
+    }
+    return (double)(sum * phi / n / 3);
+}
+
+// Random lon,lat points between off and off + 3 degrees either side
+// of the central meridian, from the equator to 84N.
+static void points(double *xy, long count, double cm, double off) {
+    for (long i = 0; i < count; ++i) {
+        double d = test_random(off, off + 3);
+        xy[2*i] = cm + ((i & 1) ? d : -d);
+        xy[2*i+1] = test_random(0, 84);
+    }
+}
+
+// Project the points forward (into fwd) and back (into inv) with 
+// one series, and return the times.
+static void project(
+    TransverseMercator &tm, int kruger, double const *ll, double *fwd, double *inv,
+    long count, double *tFwd, double *tInv
+) {
+    TransverseMercator::useKruger = (kruger != 0);
+    memcpy(fwd, ll, 2 * count * sizeof(double));
+    double start = test_seconds();
+    tm.fromLatLong(fwd, (int)count);
+    *tFwd = test_seconds() - start;
+    
+    memcpy(inv, fwd, 2 * count * sizeof(double));
+    start = test_seconds();
+    tm.toLatLong(inv, (int)count);
+    *tInv = test_seconds() - start;
+}
+
+int main(int argc, char **argv) {
+    long count = (argc > 1) ? atol(argv[1]) : 1000000L;
+    if (count <= 0) {
+        puts("usage: krugertest {count}");
+        return 2;
+    }
+    
+    TransverseMercator tm;
+    tm.setSpheroid(axis, flattening);
+    PrepareUTM(tm, 20);
+    double cm = tm.getCentralMeridian();
+    
+    double *ll = (double*)malloc(10 * count * sizeof(double));
+    if (!ll) return 2;
+    double *usgsFwd = ll + 2 * count, *usgsInv = usgsFwd + 2 * count;
+    double *krFwd = usgsInv + 2 * count, *krInv = krFwd + 2 * count;
+    int failed = 0;
+    long i;
+    
+    static const double offsets[3] = { 0, 9, 20 };
+    static char const *bands[3] = { "within the zone", "9 to 12 degrees off", "20 to 23 degrees off" };
+    
+    for (int simd = 1; simd >= 0; --simd) {
+        ProjectionBase::useSIMD = (simd != 0);
+        printf("%s:\n", simd ? "With the SIMD kernels" : "Scalar");
+        
+        for (int band = 0; band < 3; ++band) {
+            double tUsgs[2], tKr[2];
+            test_seed(band + 1);
+            points(ll, count, cm, offsets[band]);
+            project(tm, 0, ll, usgsFwd, usgsInv, count, tUsgs, tUsgs + 1);
+            project(tm, 1, ll, krFwd, krInv, count, tKr, tKr + 1);
+            
+            double diff = 0, krTrip = 0, usgsTrip = 0;
+            for (i = 0; i < count; ++i) {
+                double dx = krFwd[2*i] - usgsFwd[2*i], dy = krFwd[2*i+1] - usgsFwd[2*i+1];
+                double d = sqrt(dx * dx + dy * dy);
+                double k = ground_error(krInv + 2*i, ll + 2*i);
+                double u = ground_error(usgsInv + 2*i, ll + 2*i);
+                if (!(d <= diff)) diff = d;
+                if (!(k <= krTrip)) krTrip = k;
+                if (!(u <= usgsTrip)) usgsTrip = u;
+            }
+            
+            printf(" %s, %ld points:\n", bands[band], count);
+            if (band == 0) {
+                failed += test_check("Kruger vs USGS, forward", diff, 0.003, "m");
+            } else {
+                printf("  %-40s %12.6g m\n", "Kruger vs USGS, forward", diff);
+            }
+            failed += test_check("Kruger round trip", krTrip, 1e-7, "m");
+            printf("  %-40s %12.6g m\n", "USGS round trip", usgsTrip);
+            printf("  %-40s %8.1f ns forward, %8.1f ns reverse\n", "USGS time per point",
+                tUsgs[0] * 1e9 / count, tUsgs[1] * 1e9 / count);
+            printf("  %-40s %8.1f ns forward, %8.1f ns reverse\n", "Kruger time per point",
+                tKr[0] * 1e9 / count, tKr[1] * 1e9 / count);
+        }
+    }
+    
+    // the meridian arc at 80N, from the northing on the central 
+    // meridian (there is no false northing in the northern zones)
+    double arc = meridian_arc(80) * tm.getScaleFactor();
+    double xy[2];
+    printf("Meridian arc at 80N:\n");
+    for (int kruger = 0; kruger < 2; ++kruger) {
+        TransverseMercator::useKruger = (kruger != 0);
+        xy[0] = cm;
+        xy[1] = 80;
+        tm.fromLatLong(xy, 1);
+        if (kruger) {
+            failed += test_check("Kruger vs numeric integration", fabs(xy[1] - arc), 1e-6, "m");
+        } else {
+            printf("  %-40s %12.6g m\n", "USGS vs numeric integration", fabs(xy[1] - arc));
+        }
+    }
+    
+    free(ll);
+    if (failed) {
+        printf("krugertest: %d checks failed.\n", failed);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,314 @@
+/** 
+ * soatest.cpp - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+/*
+  Checks that the calls on separate arrays of x and y, which the
+  transform pipeline makes, give exactly what the interleaved calls
+  give, and times both.
+
+    soatest {count {gsbfile}}
+  
+  soa_split and soa_join must round-trip every length up to 40.  Then
+  count random points (10^6 by default), and a few odd counts, so 
+  that every kernel leaves some points to the scalar code, go through
+  each projection both ways (and the -fast tier, -kruger and toZone),
+  the Helmert shift, and the gridshift given (or in
+  SHPTRANS_GRIDSHIFT_NTV2), if any; every bit must match.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tmerc.h"
+#include "dstereo.h"
+#include "webmerc.h"
+#include "helmert.h"
+#include "gshift.h"
+#include "testutil.h"
+
+static const double grs80[2] = { 6378137, 1 / 298.257222101 };
+static const double clarke1866[2] = { 6378206.4, 1 / 294.9786982 };
+
+// One call, both ways.
+struct Op {
+    virtual int pairs(double *xy, int count) = 0;
+    virtual int arrays(double *x, double *y, int count) = 0;
+    virtual ~Op() {}
+};
+
+// fromLatLong, toLatLong, fromLatLongFast or toLatLongFast
+struct ProjOp: Op {
+    ProjectionBase &prj;
+    int which;
+    ProjOp(ProjectionBase &prj, int which): prj(prj), which(which) {}
+    int pairs(double *xy, int count) {
+        switch (which) {
+          case 0: return prj.fromLatLong(xy, count);
+          case 1: return prj.toLatLong(xy, count);
+          case 2: return prj.fromLatLongFast(xy, count);
+          default: return prj.toLatLongFast(xy, count);
+        }
+    }
+    int arrays(double *x, double *y, int count) {
+        switch (which) {
+          case 0: return prj.fromLatLong(x, y, count);
+          case 1: return prj.toLatLong(x, y, count);
+          case 2: return prj.fromLatLongFast(x, y, count);
+          default: return prj.toLatLongFast(x, y, count);
+        }
+    }
+};
+
+struct ZoneOp: Op {
+    TransverseMercator &from, &to;
+    ZoneOp(TransverseMercator &from, TransverseMercator &to): from(from), to(to) {}
+    int pairs(double *xy, int count) { return from.toZone(to, xy, count); }
+    int arrays(double *x, double *y, int count) { return from.toZone(to, x, y, count); }
+};
+
+struct HelmertOp: Op {
+    HelmertShift &helmert;
+    int reverse;
+    HelmertOp(HelmertShift &helmert, int reverse): helmert(helmert), reverse(reverse) {}
+    int pairs(double *xy, int count) {
+        return reverse ? helmert.reverse(xy, count) : helmert.forward(xy, count);
+    }
+    int arrays(double *x, double *y, int count) {
+        return reverse ? helmert.reverse(x, y, count) : helmert.forward(x, y, count);
+    }
+};
+
+struct GridOp: Op {
+    GridShift &gs;
+    int reverse;
+    GridOp(GridShift &gs, int reverse): gs(gs), reverse(reverse) {}
+    int pairs(double *xy, int count) {
+        return reverse ? gs.reverse(xy, count) : gs.forward(xy, count);
+    }
+    int arrays(double *x, double *y, int count) {
+        return reverse ? gs.reverse(x, y, count) : gs.forward(x, y, count);
+    }
+};
+
+// Apply op to the count points xy, interleaved and as arrays, and 
+// count the points that differ in any bit.  The output is left in xy,
+// for the next call.  work is 4 * count doubles.
+static int compare(char const *name, Op &op, double *xy, long count, double *work) {
+    double *pairs = work, *x = work + 2 * count, *y = work + 3 * count;
+    
+    memcpy(pairs, xy, 2 * count * sizeof(double));
+    double t0 = test_seconds();
+    int err = op.pairs(pairs, (int)count);
+    double t1 = test_seconds();
+    
+    soa_split(xy, x, y, count);
+    double t2 = test_seconds();
+    int errArrays = op.arrays(x, y, (int)count);
+    double t3 = test_seconds();
+    soa_join(x, y, xy, count);
+    
+    long differ = (err != errArrays) ? 1 : 0;
+    for (long i = 0; i < 2 * count; ++i) {
+        if (memcmp(pairs + i, xy + i, sizeof(double))) ++differ;
+    }
+    
+    if (count >= 100000) {
+        printf("  %-40s %6.1f Mpt/s interleaved, %6.1f separate\n", name,
+            count / ((t1 - t0) * 1e6 + 1e-9), count / ((t3 - t2) * 1e6 + 1e-9));
+    }
+    if (differ) {
+        printf("  %s, %ld points: %ld values differ  FAILED\n", name, count, differ);
+        return 1;
+    }
+    return 0;
+}
+
+// Fill ll with count random points in the box (min lon, min lat, max
+// lon, max lat).
+static void random_points(double *ll, long count, double const *box) {
+    for (long i = 0; i < count; ++i) {
+        ll[2*i] = test_random(box[0], box[2]);
+        ll[2*i+1] = test_random(box[1], box[3]);
+    }
+}
+
+// A grid's subgrids are only visible to a GridShift.
+class TestGrid: public GridShift {
+  public:
+    // Fill ll with count random points inside the top-level subgrids,
+    // a cell in from the edges.
+    int random_points(double *ll, long count) {
+        if (!gridData || gridData->nfiles <= 0) return 0;
+        for (long i = 0; i < count; ++i) {
+            int n = (int)test_random(0, gridData->nfiles);
+            subGridType *sg = &gridData->subGrid[n];
+            while (sg->parent >= 0) sg = &gridData->subGrid[sg->parent];
+            double dy = sg->alimit[4], dx = sg->alimit[5];
+            ll[2*i] = -test_random(sg->alimit[2] + dx, sg->alimit[3] - dx) / 3600;
+            ll[2*i+1] = test_random(sg->alimit[0] + dy, sg->alimit[1] - dy) / 3600;
+        }
+        return 1;
+    }
+};
+
+static int check_split_join() {
+    double xy[80], x[40], y[40], back[80];
+    int failed = 0;
+    
+    for (int i = 0; i < 80; ++i) xy[i] = i + 0.5;
+    for (int n = 0; n <= 40; ++n) {
+        for (int i = 0; i < 40; ++i) x[i] = y[i] = back[2*i] = back[2*i+1] = -1;
+        soa_split(xy, x, y, n);
+        soa_join(x, y, back, n);
+        for (int i = 0; i < 40; ++i) {
+            int in = (i < n);
+            if (x[i] != (in ? xy[2*i] : -1) || y[i] != (in ? xy[2*i+1] : -1) 
+                || back[2*i] != x[i] || back[2*i+1] != y[i]) {
+                printf("  split and join, %d points: wrong at %d  FAILED\n", n, i);
+                ++failed;
+                break;
+            }
+        }
+    }
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    long count = (argc > 1) ? atol(argv[1]) : 1000000L;
+    if (count <= 0) {
+        puts("usage: soatest {count {gsbfile}}");
+        return 2;
+    }
+    char *gsbFile = (argc > 2) ? argv[2] : getenv("SHPTRANS_GRIDSHIFT_NTV2");
+    
+    double *ll = (double*)malloc(6 * count * sizeof(double));
+    if (!ll) return 2;
+    double *work = ll + 2 * count;
+    int failed = 0;
+    
+    printf("SIMD level %d\n", ProjectionBase::simdLevel());
+    failed += check_split_join();
+    
+    // the whole count, then odd ones, for the kernels' leftovers
+    static const long odd[3] = { 1, 7, 29 };
+    
+    for (int c = 0; c < 4; ++c) {
+        long n = c ? ((odd[c-1] < count) ? odd[c-1] : count) : count;
+        
+        TransverseMercator mtm5, mtm4;
+        mtm5.setSpheroid(grs80[0], grs80[1]);
+        mtm4.setSpheroid(grs80[0], grs80[1]);
+        PrepareMTM(mtm5, 5);
+        PrepareMTM(mtm4, 4);
+        DoubleStereographic ds;
+        ds.setSpheroid(grs80[0], grs80[1]);
+        ds.setOriginNB();
+        ds.setFalseOffsets(2500000, 7500000);
+        WebMercator wm;
+        wm.setSpheroid(grs80[0], grs80[1]);
+        
+        static const double box[4] = { -66.0, 44.0, -62.0, 48.0 };
+        test_seed(c + 1);
+        
+        printf("%ld points:\n", n);
+        for (int kruger = 0; kruger < 2; ++kruger) {
+            TransverseMercator::useKruger = (kruger != 0);
+            for (int fast = 0; fast < 2; ++fast) {
+                ProjOp fwd(mtm5, 2 * fast), inv(mtm5, 2 * fast + 1);
+                random_points(ll, n, box);
+                failed += compare(kruger ? (fast ? "TM Kruger, fast, forward" : "TM Kruger, forward")
+                                         : (fast ? "TM, fast, forward" : "TM, forward"), fwd, ll, n, work);
+                failed += compare(kruger ? (fast ? "TM Kruger, fast, reverse" : "TM Kruger, reverse")
+                                         : (fast ? "TM, fast, reverse" : "TM, reverse"), inv, ll, n, work);
+            }
+        }
+        TransverseMercator::useKruger = false;
+        
+        random_points(ll, n, box);
+        mtm5.fromLatLong(ll, (int)n);
+        ZoneOp zone(mtm5, mtm4);
+        failed += compare("TM, zone to zone", zone, ll, n, work);
+        
+        for (int fast = 0; fast < 2; ++fast) {
+            ProjOp fwd(ds, 2 * fast), inv(ds, 2 * fast + 1);
+            random_points(ll, n, box);
+            failed += compare(fast ? "DS, fast, forward" : "DS, forward", fwd, ll, n, work);
+            failed += compare(fast ? "DS, fast, reverse" : "DS, reverse", inv, ll, n, work);
+        }
+        
+        ProjOp wmFwd(wm, 0), wmInv(wm, 1);
+        random_points(ll, n, box);
+        failed += compare("Web Mercator, forward", wmFwd, ll, n, work);
+        failed += compare("Web Mercator, reverse", wmInv, ll, n, work);
+        
+        // roughly NAD27 to NAD83
+        static const double params[7] = { -8, 160, 176, 0, 0, 0, 0 };
+        HelmertShift helmert;
+        helmert.setParameters(params);
+        helmert.setSpheroids(clarke1866[0], clarke1866[1], grs80[0], grs80[1]);
+        HelmertOp hFwd(helmert, 0), hInv(helmert, 1);
+        random_points(ll, n, box);
+        failed += compare("Helmert, forward", hFwd, ll, n, work);
+        failed += compare("Helmert, reverse", hInv, ll, n, work);
+        
+        TestGrid gs;
+        if (gsbFile && gs.open(gsbFile) == GRID_OK) {
+            GridOp gFwd(gs, 0), gInv(gs, 1);
+            gs.random_points(ll, n);
+            failed += compare("gridshift, forward", gFwd, ll, n, work);
+            failed += compare("gridshift, reverse", gInv, ll, n, work);
+        } else if (!c) {
+            printf("gridshift: no GSB file given, skipped\n");
+        }
+    }
+    
+    free(ll);
+    if (failed) {
+        printf("soatest: %d checks failed.\n", failed);
+        return 1;
+    }
+    return 0;
+}
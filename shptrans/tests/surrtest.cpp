@@ -0,0 +1,200 @@
+/** 
+ * surrtest.cpp - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  Checks -surrogate against the exact transformation, at random 
+  points inside the extent it covers.
+
+    surrtest {count {gsbfile}}
+  
+  transforms count random points (10^6 by default) over an 80 km 
+  square in New Brunswick, from MTM zone 5 to the NB Double 
+  Stereographic projection, with the surrogate at 1 mm and exactly,
+  and fails if any point differs by more than 1 mm.  With the NTv2
+  grid given (or in SHPTRANS_GRIDSHIFT_NTV2), the same is done from
+  NAD27 to NAD83, and back, at 1 mm and 0.1 mm, over smaller squares
+  where the gridshift has a kink at the edge of every cell.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "surrogate.h"
+#include "testutil.h"
+
+static const double grs80[2] = { 6378137, 1 / 298.257222101 };
+static const double clarke1866[2] = { 6378206.4, 1 / 294.9786982 };
+
+// Transform count random points, in a square of side size (metres)
+// centred on lon,lat, with the surrogate at tolerance and exactly, 
+// and check the largest difference.
+static int compare(
+    char const *name, transform_fn exact, TransformStages &stages, double tolerance,
+    double lon, double lat, double size, double *x, double *y, double *refX, double *refY, long count
+) {
+    ChainSurrogate surrogate;
+    surrogate.open(exact, stages, tolerance);
+    
+    double box[4] = { lon, lat };
+    stages.from->fromLatLong(box, 1);
+    box[2] = box[0] + size / 2;
+    box[3] = box[1] + size / 2;
+    box[0] -= size / 2;
+    box[1] -= size / 2;
+    surrogate.setExtent(box);
+    
+    test_seed(count);
+    for (long i = 0; i < count; ++i) {
+        x[i] = test_random(box[0], box[2]);
+        y[i] = test_random(box[1], box[3]);
+    }
+    memcpy(refX, x, count * sizeof(double));
+    memcpy(refY, y, count * sizeof(double));
+    
+    // a record at a time, as shptrans does
+    int err = 0;
+    for (long i = 0; i < count; i += 1000) {
+        long n = (count - i < 1000) ? count - i : 1000;
+        err = surrogate.apply(x + i, y + i, n) || err;
+    }
+    err = exact(stages, refX, refY, count, 0) || err;
+    
+    double worst = 0;
+    for (long i = 0; i < count; ++i) {
+        double dx = x[i] - refX[i], dy = y[i] - refY[i];
+        double d = sqrt(dx * dx + dy * dy);
+        if (!(d <= worst)) worst = d;
+    }
+    
+    printf("%s, %g km square, %g mm, %ld points:\n", name, size / 1000, tolerance * 1000, count);
+    printf("  %ld tiles fitted, %ld exact; %ld points fitted, %ld exact\n",
+        surrogate.getFittedTiles(), surrogate.getExactTiles(),
+        surrogate.getFittedPoints(), surrogate.getExactPoints());
+    
+    int failed = test_check("surrogate vs exact", worst, tolerance, "m");
+    if (err) {
+        printf("  some points could not be transformed  FAILED\n");
+        ++failed;
+    }
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    long count = (argc > 1) ? atol(argv[1]) : 1000000L;
+    if (count <= 0) {
+        puts("usage: surrtest {count {gsbfile}}");
+        return 2;
+    }
+    char *gsbFile = (argc > 2) ? argv[2] : getenv("SHPTRANS_GRIDSHIFT_NTV2");
+    
+    double *x = (double*)malloc(4 * count * sizeof(double));
+    if (!x) return 2;
+    double *y = x + count, *refX = x + 2 * count, *refY = x + 3 * count;
+    int failed = 0;
+    
+    TransverseMercator mtm;
+    DoubleStereographic ds;
+    mtm.setSpheroid(grs80[0], grs80[1]);
+    ds.setSpheroid(grs80[0], grs80[1]);
+    PrepareMTM(mtm, 5);
+    ds.setOriginNB();
+    ds.setFalseOffsets(2500000, 7500000);
+    
+    TransformStages stages;
+    memset(&stages, 0, sizeof(stages));
+    
+    // the projections alone, on one datum
+    stages.from = &mtm;
+    stages.to = &ds;
+    failed += compare("MTM zone 5 to NB stereographic",
+        select_transform(PIPE_TM, PIPE_DS, PIPE_DATUM_NONE), stages, 0.001,
+        -65.5, 46.0, 80000, x, y, refX, refY, count);
+    
+    // With the grid, one square in 5' cells, and a smaller one in
+    // 30" cells, across the edge of the subgrid; at 0.1 mm as well,
+    // where fitting across the edges of cells would show.
+    static const struct {
+        double lon, lat, size;
+    } squares[2] = {
+        { -65.6, 46.4, 20000 },
+        { -65.0, 45.5, 4000 },
+    };
+    
+    GridShift gs;
+    if (gsbFile && gs.open(gsbFile) == GRID_OK) {
+        mtm.setSpheroid(clarke1866[0], clarke1866[1]);
+        
+        for (int i = 0; i < 4; ++i) {
+            double tolerance = (i & 1) ? 0.0001 : 0.001;
+            stages.from = &mtm;
+            stages.to = &ds;
+            stages.forward = &gs;
+            stages.reverse = 0;
+            failed += compare("NAD27 MTM zone 5 to NAD83 NB stereographic",
+                select_transform(PIPE_TM, PIPE_DS, PIPE_DATUM_FORWARD), stages, tolerance,
+                squares[i/2].lon, squares[i/2].lat, squares[i/2].size, x, y, refX, refY, count);
+            
+            stages.from = &ds;
+            stages.to = &mtm;
+            stages.forward = 0;
+            stages.reverse = &gs;
+            failed += compare("NAD83 NB stereographic to NAD27 MTM zone 5",
+                select_transform(PIPE_DS, PIPE_TM, PIPE_DATUM_REVERSE), stages, tolerance,
+                squares[i/2].lon, squares[i/2].lat, squares[i/2].size, x, y, refX, refY, count);
+        }
+    } else {
+        printf("gridshift: no GSB file given, skipped\n");
+    }
+    
+    free(x);
+    if (failed) {
+        printf("surrtest: %d checks failed.\n", failed);
+        return 1;
+    }
+    return 0;
+}
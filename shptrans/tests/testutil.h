@@ -0,0 +1,92 @@
+/** 
+ * testutil.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  Helpers shared by the tests in this folder (see "make test").  Each
+  test is a program that prints what it measured and returns nonzero
+  if anything was out of bounds.
+*/
+
+#ifndef _TESTUTIL_H
+#define _TESTUTIL_H
+
+#include <stdio.h>
+#include <time.h>
+
+#ifndef PI
+#define PI (3.1415926535897932384626433832795028842)
+#endif
+
+// A small xorshift generator, so that every platform (and every 
+// RAND_MAX) gets the same arguments.
+static unsigned long long testSeed = 88172645463325252ULL;
+
+static inline void test_seed(unsigned long long seed) {
+    testSeed = seed ? seed : 88172645463325252ULL;
+}
+
+// uniform in [lo, hi)
+static inline double test_random(double lo, double hi) {
+    testSeed ^= testSeed << 13;
+    testSeed ^= testSeed >> 7;
+    testSeed ^= testSeed << 17;
+    return lo + (hi - lo) * ((testSeed >> 11) * (1.0 / 9007199254740992.0));
+}
+
+// processor time, in seconds, for throughput
+static inline double test_seconds() {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+// Report a measured error against its bound, and count the failure.
+static inline int test_check(char const *what, double error, double bound, char const *units) {
+    int ok = (error <= bound);   // (false for NaN)
+    printf("  %-40s %12.6g %-4s (bound %g)%s\n", what, error, units, bound, ok ? "" : "  FAILED");
+    return ok ? 0 : 1;
+}
+
+#endif
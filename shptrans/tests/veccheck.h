@@ -0,0 +1,173 @@
+/** 
+ * veccheck.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  The vecmath.h checks for one vector width.  This is included by
+  vecsse2.cpp, vecavx2.cpp and vecavx512.cpp, after defining VEC_WIDTH
+  and VEC_NAME, as the kernels are; see vectest.cpp.
+  
+  Each function is run over the arguments from vec_test_args, and its
+  results compared with the long double functions of libm, rounded
+  to the last place.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "vecmath.h"
+#include "vectest.h"
+
+// The error of got, in units in the last place of exact rounded to
+// a double (bits = 53) or a float (24).
+static double ulps(long double exact, double got, int bits) {
+    int e;
+    frexp((double)exact, &e);
+    return (double)(fabsl((long double)got - exact) / ldexp(1.0, e - bits));
+}
+
+// vec_sincos and vecf_sincos, with one result each; the sum is
+// what is timed
+static inline vdouble vsin(vdouble x) { vdouble s, c; vec_sincos(x, &s, &c); return s; }
+static inline vdouble vcos(vdouble x) { vdouble s, c; vec_sincos(x, &s, &c); return c; }
+static inline vdouble vsincos(vdouble x) { vdouble s, c; vec_sincos(x, &s, &c); return s + c; }
+static inline vfloat vsinf(vfloat x) { vfloat s, c; vecf_sincos(x, &s, &c); return s; }
+static inline vfloat vcosf(vfloat x) { vfloat s, c; vecf_sincos(x, &s, &c); return c; }
+static inline vfloat vsincosf(vfloat x) { vfloat s, c; vecf_sincos(x, &s, &c); return s + c; }
+
+// Apply EXPR, of vdoubles x and y, to count arguments from a and b,
+// and store the results in out.
+#define VEC_APPLY(EXPR) \
+    for (i = 0; i < count; i += VEC_WIDTH) { \
+        vdouble x, y, r; \
+        memcpy(&x, a + i, sizeof x); \
+        memcpy(&y, b + i, sizeof y); \
+        r = (EXPR); \
+        memcpy(out + i, &r, sizeof r); \
+    }
+
+// Likewise for vfloats, whose lanes are converted from doubles.
+#define VECF_APPLY(EXPR) \
+    for (i = 0; i < count; i += 2 * VEC_WIDTH) { \
+        vdouble lo, hi; \
+        memcpy(&lo, a + i, sizeof lo); \
+        memcpy(&hi, a + i + VEC_WIDTH, sizeof hi); \
+        vfloat x = vec_narrow(lo, hi), r = (EXPR); \
+        vec_widen(r, &lo, &hi); \
+        memcpy(out + i, &lo, sizeof lo); \
+        memcpy(out + i + VEC_WIDTH, &hi, sizeof hi); \
+    }
+
+// The worst error of EXPR against EXACT (of long doubles x and y),
+// computed with APPLY.
+#define VEC_WORST(APPLY, EXPR, EXACT, BITS) { \
+        APPLY(EXPR) \
+        for (i = 0; i < count; ++i) { \
+            long double x = a[i], y = b[i]; \
+            (void)y; \
+            double err = ulps((EXACT), out[i], BITS); \
+            if (!(err <= worst[test])) worst[test] = err; \
+        } \
+    }
+
+// The time per value of EXPR, computed with APPLY.
+#define VEC_TIME(APPLY, EXPR) { \
+        double start = test_seconds(); \
+        for (int rep = 0; rep < reps; ++rep) { \
+            APPLY(EXPR) \
+        } \
+        ns[test] = (test_seconds() - start) * 1e9 / ((double)reps * count); \
+    }
+
+#define VEC_MEASURE(APPLY, EXPR, EXACT, BITS) \
+    VEC_WORST(APPLY, EXPR, EXACT, BITS) VEC_TIME(APPLY, EXPR)
+
+void VEC_NAME(vecCheck)(long count, int reps, double *worst, double *ns) {
+    double *a = (double*)malloc(3 * count * sizeof(double));
+    if (!a) return;
+    double *b = a + count, *out = b + count;
+    long i;
+    
+    for (int test = 0; test < VT_COUNT; ++test) {
+        worst[test] = 0;
+        ns[test] = 0;
+        vec_test_args(test, count, a, b);
+        
+        switch (test) {
+        case VT_SINCOS: case VT_SINCOS_WIDE:
+            VEC_WORST(VEC_APPLY, vsin(x), sinl(x), 53);
+            VEC_WORST(VEC_APPLY, vcos(x), cosl(x), 53);
+            VEC_TIME(VEC_APPLY, vsincos(x));
+            break;
+        case VT_LOG:    VEC_MEASURE(VEC_APPLY, vec_log(x), logl(x), 53); break;
+        case VT_EXP:    VEC_MEASURE(VEC_APPLY, vec_exp(x), expl(x), 53); break;
+        case VT_ATAN:   VEC_MEASURE(VEC_APPLY, vec_atan(x), atanl(x), 53); break;
+        case VT_ASIN:   VEC_MEASURE(VEC_APPLY, vec_asin(x), asinl(x), 53); break;
+        case VT_TAN: case VT_TAN_WIDE:
+                        VEC_MEASURE(VEC_APPLY, vec_tan(x), tanl(x), 53); break;
+        case VT_ATAN2:  VEC_MEASURE(VEC_APPLY, vec_atan2(y, x), atan2l(y, x), 53); break;
+        case VT_POW:    VEC_MEASURE(VEC_APPLY, vec_pow(x, y), powl(x, y), 53); break;
+        case VT_SINCOSF:
+            VEC_WORST(VECF_APPLY, vsinf(x), sinl(x), 24);
+            VEC_WORST(VECF_APPLY, vcosf(x), cosl(x), 24);
+            VEC_TIME(VECF_APPLY, vsincosf(x));
+            break;
+        case VT_LOGF:   VEC_MEASURE(VECF_APPLY, vecf_log(x), logl(x), 24); break;
+        case VT_EXPF:   VEC_MEASURE(VECF_APPLY, vecf_exp(x), expl(x), 24); break;
+        case VT_ASINF:  VEC_MEASURE(VECF_APPLY, vecf_asin(x), asinl(x), 24); break;
+        case VT_ATANHF: VEC_MEASURE(VECF_APPLY, vecf_atanh(x), atanhl(x), 24); break;
+        case VT_SINHF:  VEC_MEASURE(VECF_APPLY, vecf_sinh(x), sinhl(x), 24); break;
+        }
+    }
+    
+    free(a);
+}
+
+#undef VEC_APPLY
+#undef VECF_APPLY
+#undef VEC_WORST
+#undef VEC_TIME
+#undef VEC_MEASURE
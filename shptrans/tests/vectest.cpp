@@ -0,0 +1,158 @@
+/** 
+ * vectest.cpp - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  Checks the error bounds given in vecmath.h, at each vector width 
+  this CPU can run, and times each function against libm.  
+
+    vectest {count}
+  
+  runs each function over count random arguments (10^6 by default;
+  the bounds were found with 10^7) and prints the worst error, in
+  units in the last place, and the time per value, in nanoseconds.
+  It fails if any error is over its bound.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "projbase.h"
+#include "vectest.h"
+
+// The time per value of the libm function (in double or float) for 
+// a test, over the same arguments.
+static double libm_time(int test, long count, int reps, double const *a, double const *b, double *out) {
+    double start = test_seconds();
+    long i;
+    
+    for (int rep = 0; rep < reps; ++rep) {
+        for (i = 0; i < count; ++i) {
+            double x = a[i], y = b[i];
+            float f = (float)x;
+            switch (test) {
+            case VT_SINCOS: case VT_SINCOS_WIDE: out[i] = sin(x) + cos(x); break;
+            case VT_LOG:    out[i] = log(x); break;
+            case VT_EXP:    out[i] = exp(x); break;
+            case VT_ATAN:   out[i] = atan(x); break;
+            case VT_ASIN:   out[i] = asin(x); break;
+            case VT_TAN: case VT_TAN_WIDE: out[i] = tan(x); break;
+            case VT_ATAN2:  out[i] = atan2(y, x); break;
+            case VT_POW:    out[i] = pow(x, y); break;
+            case VT_SINCOSF: out[i] = sinf(f) + cosf(f); break;
+            case VT_LOGF:   out[i] = logf(f); break;
+            case VT_EXPF:   out[i] = expf(f); break;
+            case VT_ASINF:  out[i] = asinf(f); break;
+            case VT_ATANHF: out[i] = atanhf(f); break;
+            case VT_SINHF:  out[i] = sinhf(f); break;
+            }
+        }
+    }
+    return (test_seconds() - start) * 1e9 / ((double)reps * count);
+}
+
+int main(int argc, char **argv) {
+    long count = (argc > 1) ? atol(argv[1]) : 1000000L;
+    int reps = 10;
+    count = (count + 15) & ~15L;
+    if (count <= 0) {
+        puts("usage: vectest {count}");
+        return 2;
+    }
+    
+    int level = ProjectionBase::simdLevel();
+    if (level == SIMD_NONE) {
+        puts("vectest: this CPU has no SIMD kernels; nothing to check.");
+        return 0;
+    }
+    
+    static char const *names[] = { "SSE2", "AVX2", "AVX-512" };
+    double worst[3][VT_COUNT], ns[3][VT_COUNT], libmNs[VT_COUNT];
+    int widths = level - SIMD_SSE2 + 1;
+    int w, test, failed = 0;
+    
+    vecCheckSSE2(count, reps, worst[0], ns[0]);
+    if (level >= SIMD_AVX2) vecCheckAVX2(count, reps, worst[1], ns[1]);
+    if (level >= SIMD_AVX512) vecCheckAVX512(count, reps, worst[2], ns[2]);
+    
+    double *a = (double*)malloc(3 * count * sizeof(double));
+    if (!a) return 2;
+    for (test = 0; test < VT_COUNT; ++test) {
+        vec_test_args(test, count, a, a + count);
+        libmNs[test] = libm_time(test, count, reps, a, a + count, a + 2 * count);
+    }
+    free(a);
+    
+    printf("Worst error (ulp) over %ld arguments, and bound:\n", count);
+    printf("  %-12s %6s", "", "bound");
+    for (w = 0; w < widths; ++w) printf(" %8s", names[w]);
+    printf("\n");
+    for (test = 0; test < VT_COUNT; ++test) {
+        printf("  %-12s %6.1f", vecTests[test].name, vecTests[test].bound);
+        for (w = 0; w < widths; ++w) {
+            int ok = (worst[w][test] <= vecTests[test].bound);
+            printf(" %7.2f%c", worst[w][test], ok ? ' ' : '!');
+            if (!ok) ++failed;
+        }
+        printf("\n");
+    }
+    
+    printf("\nTime per value (ns):\n");
+    printf("  %-12s %6s", "", "libm");
+    for (w = 0; w < widths; ++w) printf(" %8s", names[w]);
+    printf("\n");
+    for (test = 0; test < VT_COUNT; ++test) {
+        printf("  %-12s %6.2f", vecTests[test].name, libmNs[test]);
+        for (w = 0; w < widths; ++w) printf(" %8.2f", ns[w][test]);
+        printf("\n");
+    }
+    
+    if (failed) {
+        printf("\nvectest: %d errors over their bounds (marked !).\n", failed);
+        return 1;
+    }
+    return 0;
+}
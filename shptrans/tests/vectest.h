@@ -0,0 +1,155 @@
+/** 
+ * vectest.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  Declarations shared by vectest.cpp and the per-width checks in
+  veccheck.h: the functions of vecmath.h that are checked, the bound
+  that vecmath.h gives for each, and the arguments they are given.
+*/
+
+#ifndef _VECTEST_H
+#define _VECTEST_H
+
+#include <math.h>
+#include "testutil.h"
+
+enum {
+    VT_SINCOS, VT_SINCOS_WIDE, VT_LOG, VT_EXP, VT_ATAN, VT_ASIN, 
+    VT_TAN, VT_TAN_WIDE, VT_ATAN2, VT_POW,
+    VT_SINCOSF, VT_LOGF, VT_EXPF, VT_ASINF, VT_ATANHF, VT_SINHF,
+    VT_COUNT
+};
+
+// as documented in vecmath.h, in units in the last place of a double
+// (or, from VT_SINCOSF on, of a float)
+static const struct {
+    char const *name;
+    double bound;
+} vecTests[VT_COUNT] = {
+    { "vec_sincos", 1.6 },
+    { "  to 1e5", 2.5 },
+    { "vec_log", 0.9 },
+    { "vec_exp", 1.2 },
+    { "vec_atan", 1.0 },
+    { "vec_asin", 2.5 },
+    { "vec_tan", 3.5 },
+    { "  to 1e5", 4.5 },
+    { "vec_atan2", 1.6 },
+    { "vec_pow", 4.0 },
+    { "vecf_sincos", 1.6 },
+    { "vecf_log", 0.8 },
+    { "vecf_exp", 1.1 },
+    { "vecf_asin", 2.4 },
+    { "vecf_atanh", 2.8 },
+    { "vecf_sinh", 2.6 },
+};
+
+// Random arguments for a test, over the domain vecmath.h gives for
+// it; b is the second argument where there is one.  The arguments
+// for the single precision functions are floats.
+static void vec_test_args(int test, long count, double *a, double *b) {
+    test_seed(test + 1);
+    for (long i = 0; i < count; ++i) {
+        double x = 0, y = 0;
+        switch (test) {
+        case VT_SINCOS: case VT_TAN:
+            // mostly near the origin, as in the projections
+            x = (i & 1) ? test_random(-100, 100) : test_random(-4, 4);
+            break;
+        case VT_SINCOS_WIDE: case VT_TAN_WIDE:
+            x = test_random(-1e5, 1e5);
+            break;
+        case VT_LOG:
+            x = exp(test_random(-700, 700));
+            break;
+        case VT_EXP:
+            x = test_random(-708, 708);
+            break;
+        case VT_ATAN:
+            x = test_random(-1, 1) * pow(10.0, test_random(-6, 6));
+            break;
+        case VT_ASIN:
+            x = test_random(-1, 1);
+            break;
+        case VT_ATAN2:
+            x = test_random(-1, 1) * pow(10.0, test_random(-3, 3));
+            y = test_random(-1, 1) * pow(10.0, test_random(-3, 3));
+            break;
+        case VT_POW:
+            // |y log x| < 2
+            x = exp(test_random(-4, 4));
+            y = test_random(-2, 2) / fabs(log(x));
+            break;
+        case VT_SINCOSF:
+            x = (float)test_random(-4, 4);
+            break;
+        case VT_LOGF:
+            x = (float)exp(test_random(-87, 87));
+            break;
+        case VT_EXPF: case VT_SINHF:
+            x = (float)test_random(-87, 87);
+            break;
+        case VT_ASINF:
+            x = (float)test_random(-1, 1);
+            break;
+        case VT_ATANHF:
+            x = (float)test_random(-0.999, 0.999);
+            break;
+        }
+        a[i] = x;
+        b[i] = y;
+    }
+}
+
+// The checks for each width: the worst error of each function over
+// count arguments, and the time per value (nanoseconds) over reps 
+// passes; count must be a multiple of 16.
+void vecCheckSSE2(long count, int reps, double *worst, double *ns);
+void vecCheckAVX2(long count, int reps, double *worst, double *ns);
+void vecCheckAVX512(long count, int reps, double *worst, double *ns);
+
+#endif
@@ -71,6 +71,33 @@
     Written by Chuck Gantz- chuck.gantz@globalstar.com
 */
 
+bool TransverseMercator::useKruger = false;
+
+bool TransverseMercator::memoLatitude = false;
+long TransverseMercator::memoHits = 0;
+long TransverseMercator::memoMisses = 0;
+
+/*
+  The memo is direct-mapped: each latitude (or northing) has one slot,
+  by a hash of its bits, and a miss replaces whatever was there.  It
+  is keyed on the exact value, so a hit gives exactly what computing
+  the terms again would.  Data vectorised from a raster or graticule
+  has long runs of vertices on a few rows, which this catches; other
+  data just misses, at the cost of a hash and a store.
+*/
+static inline unsigned memo_slot(double key) {
+    union { double d; unsigned int w[2]; } bits;
+    bits.d = key;
+    return ((bits.w[0] ^ bits.w[1]) * 2654435761u) >> 24;  // memoSize = 256
+}
+
+void TransverseMercator::clearMemo() {
+    for (int i = 0; i < memoSize; ++i) {
+        latMemo[i].lat = HUGE_VAL;
+        footMemo[i].M = HUGE_VAL;
+    }
+}
+
 int TransverseMercator::setCentralMeridian(double cenMerid) {
     lon0 = cenMerid * (PI/180);
     return PROJ_SUCCESS;
@@ -108,11 +135,56 @@ int TransverseMercator::spheroidChanged() {
     A2 *= (3.0/8.0);
     A4 *= (15.0/256.0);
     A6 *= (35.0/3072.0);
+    
+    // Kruger series coefficients, to 6th order in the third 
+    // flattening n (Karney, "Transverse Mercator with an accuracy
+    // of a few nanometers", J. Geodesy 85, 2011).
+    double n = f / (2 - f);
+    double n2 = n*n, n3 = n2*n, n4 = n3*n, n5 = n4*n, n6 = n5*n;
+    
+    e = sqrt(esq);
+    rectA = a / (1 + n) * (1 + n2/4 + n4/64 + n6/256);
+    
+    alpha[0] = n/2 - n2*2/3 + n3*5/16 + n4*41/180 - n5*127/288 + n6*7891/37800;
+    alpha[1] = n2*13/48 - n3*3/5 + n4*557/1440 + n5*281/630 - n6*1983433/1935360;
+    alpha[2] = n3*61/240 - n4*103/140 + n5*15061/26880 + n6*167603/181440;
+    alpha[3] = n4*49561/161280 - n5*179/168 + n6*6601661/7257600;
+    alpha[4] = n5*34729/80640 - n6*3418889/1995840;
+    alpha[5] = n6*212378941/319334400;
+    
+    beta[0] = n/2 - n2*2/3 + n3*37/96 - n4/360 - n5*81/512 + n6*96199/604800;
+    beta[1] = n2/48 + n3/15 - n4*437/1440 + n5*46/105 - n6*1118711/3870720;
+    beta[2] = n3*17/480 - n4*37/840 - n5*209/4480 + n6*5569/90720;
+    beta[3] = n4*4397/161280 - n5*11/504 - n6*830251/7257600;
+    beta[4] = n5*4583/161280 - n6*108847/3991680;
+    beta[5] = n6*20648693/638668800;
+    
+    latSeries[0] = n*2 - n2*2/3 - n3*2 + n4*116/45 + n5*26/45 - n6*2854/675;
+    latSeries[1] = n2*7/3 - n3*8/5 - n4*227/45 + n5*2704/315 + n6*2323/945;
+    latSeries[2] = n3*56/15 - n4*136/35 - n5*1262/105 + n6*73814/2835;
+    latSeries[3] = n4*4279/630 - n5*332/35 - n6*399572/14175;
+    latSeries[4] = n5*4174/315 - n6*144838/6237;
+    latSeries[5] = n6*601676/22275;
+    
+    clearMemo();
   
     return PROJ_SUCCESS;
 }
 
 int TransverseMercator::fromLatLong(double *xy, int count) {
+    if (useKruger) return krugerFromLatLong(xy, count);
+    
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = fromLatLongAVX512(PointPairs(xy), count); break;
+      case SIMD_AVX2: done = fromLatLongAVX2(PointPairs(xy), count); break;
+      case SIMD_SSE2: done = fromLatLongSSE2(PointPairs(xy), count); break;
+    }
+    xy += 2 * done;
+    count -= done;
+#endif
+    
     double N, T, C, Q, Q2, Q3, Q4, Q5, Q6 , M;
     double lat;
     double lon;
@@ -121,27 +193,53 @@ int TransverseMercator::fromLatLong(double *xy, int count) {
     double sinlat, sinsqlat;
     double tanlat, tansqlat;
     
+    const bool useMemo = memoLatitude;
+    long hits = 0;
+    
     for (int coordIdx=0; coordIdx<count; ++coordIdx,xy+=2) {
         lon = xy[0] * (PI/180);
         lat = xy[1] * (PI/180);
-    
-        sin_cos(lat, &sinlat, &coslat);
-        tanlat = sinlat / coslat;
-        sinsqlat = square(sinlat);
-        cossqlat = square(coslat);
-        tansqlat = square(tanlat);
         
-        N = a/sqrt(1-esq*sinsqlat);
-        T = tansqlat;
-        C = e1sq*cossqlat;
+        LatTerms *memo = useMemo ? latMemo + memo_slot(lat) : 0;
+        
+        if (memo && memo->lat == lat) {
+            coslat = memo->coslat;
+            tanlat = memo->tanlat;
+            N = memo->N;
+            T = memo->T;
+            C = memo->C;
+            M = memo->M;
+            ++hits;
+        } else {
+            sin_cos(lat, &sinlat, &coslat);
+            tanlat = sinlat / coslat;
+            sinsqlat = square(sinlat);
+            cossqlat = square(coslat);
+            tansqlat = square(tanlat);
+            
+            N = a/sqrt(1-esq*sinsqlat);
+            T = tansqlat;
+            C = e1sq*cossqlat;
+            
+            M=a*(A0*lat-A2*sin(2*lat)+A4*sin(4*lat)-A6*sin(6*lat)+A8*sin(8*lat));
+            
+            if (memo) {
+                memo->lat = lat;
+                memo->coslat = coslat;
+                memo->tanlat = tanlat;
+                memo->N = N;
+                memo->T = T;
+                memo->C = C;
+                memo->M = M;
+            }
+        }
+        
         Q = coslat*(lon-lon0);
         Q2 = Q * Q;
         Q3 = Q2 * Q;
         Q4 = Q3 * Q;
         Q5 = Q4 * Q;
         Q6 = Q5 * Q;
-        
-        M=a*(A0*lat-A2*sin(2*lat)+A4*sin(4*lat)-A6*sin(6*lat)+A8*sin(8*lat));
     
         xy[0] = (k0*N*(Q+(1-T+C)*Q3/6
          + (5-18*T+T*T+72*C-58*e1sq)*Q5/120)
@@ -151,13 +249,67 @@ int TransverseMercator::fromLatLong(double *xy, int count) {
          + (61-58*T+T*T+600*C-330*e1sq)*Q6/720))
          + y0);
     }
+    
+    if (memoLatitude) {
+        memoHits += hits;
+        memoMisses += count - hits;
+    }
   
     return PROJ_SUCCESS;
 }
 
 
 
+// The -fast tier, where there are SIMD kernels for it; the USGS
+// series only, as the Kruger series is meant for accuracy.
+int TransverseMercator::fromLatLongFast(double *xy, int count) {
+#ifdef HAVE_SIMD_KERNELS
+    if (!useKruger) {
+        int done = 0;
+        switch (simdLevel()) {
+          case SIMD_AVX512: done = fastFromLatLongAVX512(PointPairs(xy), count); break;
+          case SIMD_AVX2: done = fastFromLatLongAVX2(PointPairs(xy), count); break;
+          case SIMD_SSE2: done = fastFromLatLongSSE2(PointPairs(xy), count); break;
+        }
+        xy += 2 * done;
+        count -= done;
+    }
+#endif
+    return fromLatLong(xy, count);
+}
+
+int TransverseMercator::toLatLongFast(double *xy, int count) {
+#ifdef HAVE_SIMD_KERNELS
+    if (!useKruger) {
+        int done = 0;
+        switch (simdLevel()) {
+          case SIMD_AVX512: done = fastToLatLongAVX512(PointPairs(xy), count); break;
+          case SIMD_AVX2: done = fastToLatLongAVX2(PointPairs(xy), count); break;
+          case SIMD_SSE2: done = fastToLatLongSSE2(PointPairs(xy), count); break;
+        }
+        xy += 2 * done;
+        count -= done;
+    }
+#endif
+    return toLatLong(xy, count);
+}
+
+
+
 int TransverseMercator::toLatLong(double *xy, int count) {
+    if (useKruger) return krugerToLatLong(xy, count);
+    
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = toLatLongAVX512(PointPairs(xy), count); break;
+      case SIMD_AVX2: done = toLatLongAVX2(PointPairs(xy), count); break;
+      case SIMD_SSE2: done = toLatLongSSE2(PointPairs(xy), count); break;
+    }
+    xy += 2 * done;
+    count -= done;
+#endif
+    
     double N1, T1, C1, R1, D, M;
     double mu, phi1;
   
@@ -169,63 +321,108 @@ int TransverseMercator::toLatLong(double *xy, int count) {
     double delta;
     double eff, eff1;
     
-    const double errmax = highPrecision ? epsilon / 100000 : epsilon;
+    // With a -tolerance, stop once the error left is within it.  Newton's
+    // method converges quadratically here: the error after a step is
+    // about f''/2f' times the square of the step, and f''/2f' is under
+    // e^2, so the square of the step is a safe bound.  Otherwise, stop
+    // when the step itself is below the fixed threshold, as before.
+    const double errmax = angularTolerance();
+    const bool squared = (tolerance > 0);
     const int maxiter = highPrecision ? 1000 : 100;
     
+    long steps = 0;
+    int maxSteps = 0;
+    double maxError = 0;
+    
+    const bool useMemo = memoLatitude;
+    long hits = 0;
+    
     for (int coordIdx=0; coordIdx<count; ++coordIdx,xy+=2) {
         x = xy[0] - x0;
         y = xy[1] - y0;
     
         M = y / k0;
-        mu = M/(a*A0);
-    
-        // This is how Chuck calculated phi1.
-        phi1 = mu + (3*e1/2-27*e1*e1*e1/32)*sin(2*mu)
-            + (21*e1*e1/16-55*e1*e1*e1*e1/32)*sin(4*mu)
-            +(151*e1*e1*e1/96)*sin(6*mu);
-    
-        // But that is just an approximation.  Below,
-        // I have added the iterative method from
-        // "Explanation of Control Survey Data Terms"
-        // to improve precision.  Chuck's approximation
-        // is cheaper than an iteration and generally
-        // reduces the number of iterations by 1,
-        // so I left it in instead of starting with mu.
-         
-        int iter = 0;
-        do {
-            sin_cos(2*phi1, &sinphi1, &cosphi1);
-            eff = A0*phi1 - A2 * sinphi1 - M/a;
-            eff1 = A0 - 2*A2*cosphi1;
-      
-            sin_cos(4*phi1, &sinphi1, &cosphi1);
-            eff += A4*sinphi1;
-            eff1 += 4*A4*cosphi1;
-      
-            sin_cos(6*phi1, &sinphi1, &cosphi1);
-            eff -= A6*sinphi1;
-            eff1 -= 6*A6*cosphi1;
-      
-            sin_cos(8*phi1, &sinphi1, &cosphi1);
-            eff += A8*sinphi1;
-            eff1 -= 8*A8*cosphi1;
-      
-            delta = eff/eff1;
-            
-            phi1 -= delta;
-        } while ((fabs(delta) > errmax) && (++iter < maxiter));
-    
-    
-        sin_cos(phi1,&sinphi1,&cosphi1);
-        tanphi1 = sinphi1 / cosphi1;
-        sinsqphi1 = square(sinphi1);
-        cossqphi1 = square(cosphi1);
-        tansqphi1 = square(tanphi1);
-    
-        N1 = a/sqrt(1-esq*sinsqphi1);
-        T1 = tansqphi1;
-        C1 = e1sq*cossqphi1;
-        R1 = a*(1-esq)/pow(1-esq*sinsqphi1, 1.5);
+        
+        // The footpoint latitude and its terms depend only on M.
+        FootTerms *memo = useMemo ? footMemo + memo_slot(M) : 0;
+        
+        if (memo && memo->M == M) {
+            phi1 = memo->phi1;
+            cosphi1 = memo->cosphi1;
+            tanphi1 = memo->tanphi1;
+            N1 = memo->N1;
+            T1 = memo->T1;
+            C1 = memo->C1;
+            R1 = memo->R1;
+            ++hits;
+        } else {
+            mu = M/(a*A0);
+
+            // This is how Chuck calculated phi1.
+            phi1 = mu + (3*e1/2-27*e1*e1*e1/32)*sin(2*mu)
+                + (21*e1*e1/16-55*e1*e1*e1*e1/32)*sin(4*mu)
+                +(151*e1*e1*e1/96)*sin(6*mu);
+
+            // But that is just an approximation.  Below,
+            // I have added the iterative method from
+            // "Explanation of Control Survey Data Terms"
+            // to improve precision.  Chuck's approximation
+            // is cheaper than an iteration and generally
+            // reduces the number of iterations by 1,
+            // so I left it in instead of starting with mu.
+
+            int iter = 0;
+            do {
+                sin_cos(2*phi1, &sinphi1, &cosphi1);
+                eff = A0*phi1 - A2 * sinphi1 - M/a;
+                eff1 = A0 - 2*A2*cosphi1;
+
+                sin_cos(4*phi1, &sinphi1, &cosphi1);
+                eff += A4*sinphi1;
+                eff1 += 4*A4*cosphi1;
+
+                sin_cos(6*phi1, &sinphi1, &cosphi1);
+                eff -= A6*sinphi1;
+                eff1 -= 6*A6*cosphi1;
+
+                sin_cos(8*phi1, &sinphi1, &cosphi1);
+                eff += A8*sinphi1;
+                eff1 -= 8*A8*cosphi1;
+
+                delta = eff/eff1;
+
+                phi1 -= delta;
+            } while (((squared ? delta*delta : fabs(delta)) > errmax) && (++iter < maxiter));
+
+            if (iter < maxiter) ++iter; // now the number of steps
+            steps += iter;
+            if (iter > maxSteps) maxSteps = iter;
+            if (delta*delta > maxError) maxError = delta*delta;
+
+
+            sin_cos(phi1,&sinphi1,&cosphi1);
+            tanphi1 = sinphi1 / cosphi1;
+            sinsqphi1 = square(sinphi1);
+            cossqphi1 = square(cosphi1);
+            tansqphi1 = square(tanphi1);
+
+            N1 = a/sqrt(1-esq*sinsqphi1);
+            T1 = tansqphi1;
+            C1 = e1sq*cossqphi1;
+            R1 = a*(1-esq)/pow(1-esq*sinsqphi1, 1.5);
+
+            if (memo) {
+                memo->M = M;
+                memo->phi1 = phi1;
+                memo->cosphi1 = cosphi1;
+                memo->tanphi1 = tanphi1;
+                memo->N1 = N1;
+                memo->T1 = T1;
+                memo->C1 = C1;
+                memo->R1 = R1;
+            }
+        }
+        
         D = x/(N1*k0);
     
         lat = (
@@ -245,12 +442,324 @@ int TransverseMercator::toLatLong(double *xy, int count) {
         
         xy[0] = (lon + lon0) * (180/PI);
     }
+    
+    addSolverStats(count - hits, steps, maxSteps, maxError);
+    
+    if (memoLatitude) {
+        memoHits += hits;
+        memoMisses += count - hits;
+    }
   
     return PROJ_SUCCESS;
 }
 
 
 
+/*
+  The Kruger series (in the form given by Karney, 2011) maps the
+  conformal sphere to the transverse Mercator plane by a series in
+  sin(2j * zeta), where zeta = xi + i*eta is a complex coordinate 
+  on the Gauss-Schreiber projection.  Both directions are a fixed
+  sequence of about ten transcendental calls, with no iteration, 
+  and are good to well under a millimetre as far as 30 degrees or
+  so from the central meridian.  The series are summed with the 
+  Clenshaw recurrence; in complex form for the projection, and in
+  real form for conformal to geodetic latitude.
+*/
+
+// Sum c[0] sin(2 zeta) + ... + c[5] sin(12 zeta), for complex zeta
+// given by sin and cos of 2 xi and sinh and cosh of 2 eta.  The
+// sum is added to *xi and *eta.
+static inline void clenshaw_complex(
+    double const *c, double sin2xi, double cos2xi, 
+    double sinh2eta, double cosh2eta, double *xi, double *eta
+) {
+    // 2 cos(2 zeta)
+    double ar = 2 * cos2xi * cosh2eta;
+    double ai = -2 * sin2xi * sinh2eta;
+    
+    double y1r = 0, y1i = 0, y2r = 0, y2i = 0;
+    for (int j = 5; j >= 0; --j) {
+        double y0r = ar * y1r - ai * y1i - y2r + c[j];
+        double y0i = ar * y1i + ai * y1r - y2i;
+        y2r = y1r; y2i = y1i;
+        y1r = y0r; y1i = y0i;
+    }
+    
+    // times sin(2 zeta)
+    double sr = sin2xi * cosh2eta;
+    double si = cos2xi * sinh2eta;
+    *xi  += sr * y1r - si * y1i;
+    *eta += sr * y1i + si * y1r;
+}
+
+int TransverseMercator::krugerFromLatLong(double *xy, int count) {
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = krugerFromLatLongAVX512(PointPairs(xy), count); break;
+      case SIMD_AVX2: done = krugerFromLatLongAVX2(PointPairs(xy), count); break;
+      case SIMD_SSE2: done = krugerFromLatLongSSE2(PointPairs(xy), count); break;
+    }
+    xy += 2 * done;
+    count -= done;
+#endif
+    
+    double sinlat, coslat, sinlon, coslon;
+    double s2, c2;
+    
+    for (int coordIdx=0; coordIdx<count; ++coordIdx,xy+=2) {
+        double lon = xy[0] * (PI/180) - lon0;
+        double lat = xy[1] * (PI/180);
+    
+        sin_cos(lat, &sinlat, &coslat);
+        sin_cos(lon, &sinlon, &coslon);
+        
+        // tangent of the conformal latitude; sigma is 
+        // sinh(e * atanh(e * sinlat))
+        double tau = sinlat / coslat;
+        double p = pow((1 + e * sinlat) / (1 - e * sinlat), e / 2);
+        double sigma = (p - 1/p) / 2;
+        double taup = tau * sqrt(1 + sigma * sigma) - sigma * sqrt(1 + tau * tau);
+        
+        // Gauss-Schreiber: eta is asinh(q), and exp(eta) falls
+        // out along the way.
+        double xi = atan2(taup, coslon);
+        double q = sinlon / sqrt(taup * taup + coslon * coslon);
+        double ex = (q >= 0) ? q + sqrt(q * q + 1) : 1 / (sqrt(q * q + 1) - q);
+        double eta = log(ex);
+        
+        sin_cos(2 * xi, &s2, &c2);
+        ex *= ex;
+        clenshaw_complex(alpha, s2, c2, (ex - 1/ex) / 2, (ex + 1/ex) / 2, &xi, &eta);
+        
+        xy[0] = k0 * rectA * eta + x0;
+        xy[1] = k0 * rectA * xi + y0;
+    }
+    
+    return PROJ_SUCCESS;
+}
+
+int TransverseMercator::krugerToLatLong(double *xy, int count) {
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = krugerToLatLongAVX512(PointPairs(xy), count); break;
+      case SIMD_AVX2: done = krugerToLatLongAVX2(PointPairs(xy), count); break;
+      case SIMD_SSE2: done = krugerToLatLongSSE2(PointPairs(xy), count); break;
+    }
+    xy += 2 * done;
+    count -= done;
+#endif
+    
+    double s2, c2;
+    double sinxi, cosxi;
+    
+    double minusBeta[6];
+    for (int j = 0; j < 6; ++j) minusBeta[j] = -beta[j];
+    
+    for (int coordIdx=0; coordIdx<count; ++coordIdx,xy+=2) {
+        double eta = (xy[0] - x0) / (k0 * rectA);
+        double xi = (xy[1] - y0) / (k0 * rectA);
+        
+        sin_cos(2 * xi, &s2, &c2);
+        double ex = exp(2 * eta);
+        clenshaw_complex(minusBeta, s2, c2, (ex - 1/ex) / 2, (ex + 1/ex) / 2, &xi, &eta);
+        
+        // back from Gauss-Schreiber to the conformal sphere
+        sin_cos(xi, &sinxi, &cosxi);
+        ex = exp(eta);
+        double sinheta = (ex - 1/ex) / 2;
+        double chi = atan2(sinxi, sqrt(sinheta * sinheta + cosxi * cosxi));
+        double lon = atan2(sinheta, cosxi);
+        
+        // conformal to geodetic latitude
+        sin_cos(2 * chi, &s2, &c2);
+        double a2 = 2 * c2;
+        double b1 = 0, b2 = 0;
+        for (int j = 5; j >= 0; --j) {
+            double b0 = a2 * b1 - b2 + latSeries[j];
+            b2 = b1;
+            b1 = b0;
+        }
+        
+        xy[1] = (chi + s2 * b1) * (180/PI);
+        xy[0] = (lon + lon0) * (180/PI);
+    }
+    
+    return PROJ_SUCCESS;
+}
+
+
+
+/*
+  Between two zones, the geodetic latitude needn't be found at all:
+  the inverse series gives the Gauss-Schreiber coordinates, which 
+  are just the conformal sphere's latitude and longitude in another
+  guise; the longitude is rotated to the other central meridian, and
+  the forward series applied.  That leaves out both conversions 
+  between conformal and geodetic latitude, and one atan2.
+*/
+int TransverseMercator::toZone(TransverseMercator &to, double *xy, int count) {
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = toZoneAVX512(to, PointPairs(xy), count); break;
+      case SIMD_AVX2: done = toZoneAVX2(to, PointPairs(xy), count); break;
+      case SIMD_SSE2: done = toZoneSSE2(to, PointPairs(xy), count); break;
+    }
+    xy += 2 * done;
+    count -= done;
+#endif
+    
+    double s2, c2;
+    double sinxi, cosxi;
+    double sinrot, cosrot;
+    
+    sin_cos(lon0 - to.lon0, &sinrot, &cosrot);
+    
+    double minusBeta[6];
+    for (int j = 0; j < 6; ++j) minusBeta[j] = -beta[j];
+    
+    for (int coordIdx=0; coordIdx<count; ++coordIdx,xy+=2) {
+        double eta = (xy[0] - x0) / (k0 * rectA);
+        double xi = (xy[1] - y0) / (k0 * rectA);
+        
+        sin_cos(2 * xi, &s2, &c2);
+        double ex = exp(2 * eta);
+        clenshaw_complex(minusBeta, s2, c2, (ex - 1/ex) / 2, (ex + 1/ex) / 2, &xi, &eta);
+        
+        // tangent of the conformal latitude, and the sine and cosine
+        // of the longitude, turned to the other central meridian
+        sin_cos(xi, &sinxi, &cosxi);
+        ex = exp(eta);
+        double sinheta = (ex - 1/ex) / 2;
+        double r = sqrt(sinheta * sinheta + cosxi * cosxi);
+        double taup = sinxi / r;
+        double coslon = (cosxi * cosrot - sinheta * sinrot) / r;
+        double sinlon = (sinheta * cosrot + cosxi * sinrot) / r;
+        
+        // and forward, as in krugerFromLatLong
+        xi = atan2(taup, coslon);
+        double q = sinlon / sqrt(taup * taup + coslon * coslon);
+        ex = (q >= 0) ? q + sqrt(q * q + 1) : 1 / (sqrt(q * q + 1) - q);
+        eta = log(ex);
+        
+        sin_cos(2 * xi, &s2, &c2);
+        ex *= ex;
+        clenshaw_complex(to.alpha, s2, c2, (ex - 1/ex) / 2, (ex + 1/ex) / 2, &xi, &eta);
+        
+        xy[0] = to.k0 * to.rectA * eta + to.x0;
+        xy[1] = to.k0 * to.rectA * xi + to.y0;
+    }
+    
+    return PROJ_SUCCESS;
+}
+
+// For separate arrays of x and y: the same kernels, reading the
+// arrays directly, with the last few points left to ProjectionBase.
+int TransverseMercator::fromLatLong(double *x, double *y, int count) {
+    if (useKruger) return krugerFromLatLong(x, y, count);
+    
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = fromLatLongAVX512(PointArrays(x, y), count); break;
+      case SIMD_AVX2: done = fromLatLongAVX2(PointArrays(x, y), count); break;
+      case SIMD_SSE2: done = fromLatLongSSE2(PointArrays(x, y), count); break;
+    }
+#endif
+    return ProjectionBase::fromLatLong(x + done, y + done, count - done);
+}
+
+int TransverseMercator::krugerFromLatLong(double *x, double *y, int count) {
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = krugerFromLatLongAVX512(PointArrays(x, y), count); break;
+      case SIMD_AVX2: done = krugerFromLatLongAVX2(PointArrays(x, y), count); break;
+      case SIMD_SSE2: done = krugerFromLatLongSSE2(PointArrays(x, y), count); break;
+    }
+#endif
+    return ProjectionBase::fromLatLong(x + done, y + done, count - done);
+}
+
+int TransverseMercator::toLatLong(double *x, double *y, int count) {
+    if (useKruger) return krugerToLatLong(x, y, count);
+    
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = toLatLongAVX512(PointArrays(x, y), count); break;
+      case SIMD_AVX2: done = toLatLongAVX2(PointArrays(x, y), count); break;
+      case SIMD_SSE2: done = toLatLongSSE2(PointArrays(x, y), count); break;
+    }
+#endif
+    return ProjectionBase::toLatLong(x + done, y + done, count - done);
+}
+
+int TransverseMercator::krugerToLatLong(double *x, double *y, int count) {
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = krugerToLatLongAVX512(PointArrays(x, y), count); break;
+      case SIMD_AVX2: done = krugerToLatLongAVX2(PointArrays(x, y), count); break;
+      case SIMD_SSE2: done = krugerToLatLongSSE2(PointArrays(x, y), count); break;
+    }
+#endif
+    return ProjectionBase::toLatLong(x + done, y + done, count - done);
+}
+
+int TransverseMercator::fromLatLongFast(double *x, double *y, int count) {
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    if (!useKruger) {
+        switch (simdLevel()) {
+          case SIMD_AVX512: done = fastFromLatLongAVX512(PointArrays(x, y), count); break;
+          case SIMD_AVX2: done = fastFromLatLongAVX2(PointArrays(x, y), count); break;
+          case SIMD_SSE2: done = fastFromLatLongSSE2(PointArrays(x, y), count); break;
+        }
+    }
+#endif
+    return fromLatLong(x + done, y + done, count - done);
+}
+
+int TransverseMercator::toLatLongFast(double *x, double *y, int count) {
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    if (!useKruger) {
+        switch (simdLevel()) {
+          case SIMD_AVX512: done = fastToLatLongAVX512(PointArrays(x, y), count); break;
+          case SIMD_AVX2: done = fastToLatLongAVX2(PointArrays(x, y), count); break;
+          case SIMD_SSE2: done = fastToLatLongSSE2(PointArrays(x, y), count); break;
+        }
+    }
+#endif
+    return toLatLong(x + done, y + done, count - done);
+}
+
+int TransverseMercator::toZone(TransverseMercator &to, double *x, double *y, int count) {
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = toZoneAVX512(to, PointArrays(x, y), count); break;
+      case SIMD_AVX2: done = toZoneAVX2(to, PointArrays(x, y), count); break;
+      case SIMD_SSE2: done = toZoneSSE2(to, PointArrays(x, y), count); break;
+    }
+#endif
+    // the rest through the interleaved version, as in ProjectionBase
+    double xy[2 * 64];
+    while (done < count) {
+        int n = (count - done < 64) ? count - done : 64;
+        soa_join(x + done, y + done, xy, n);
+        toZone(to, xy, n);
+        soa_split(xy, x + done, y + done, n);
+        done += n;
+    }
+    
+    return PROJ_SUCCESS;
+}
+
 int PrepareMTM(TransverseMercator &tm, int zone, int atlantic) {
     if (zone <= 0 || zone > 25) return PROJ_E_PARAM;
     tm.setCentralMeridian(-(zone * 3.0 + 49.5));
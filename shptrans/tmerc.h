@@ -59,10 +59,60 @@ class TransverseMercator: public ProjectionBase {
  
     int toLatLong(double *xy, int count);
     int fromLatLong(double *xy, int count);
+    int toLatLongFast(double *xy, int count);
+    int fromLatLongFast(double *xy, int count);
+    int toLatLong(double *x, double *y, int count);
+    int fromLatLong(double *x, double *y, int count);
+    int toLatLongFast(double *x, double *y, int count);
+    int fromLatLongFast(double *x, double *y, int count);
     
-    TransverseMercator() {}
+    TransverseMercator() { clearMemo(); }
+    
+    // Use the 6th-order Kruger series instead of USGS Bulletin 1532.
+    static bool useKruger;
+    
+    // Remember the terms that depend only on latitude (forward) or 
+    // on northing (reverse) for recent values, for data with many
+    // points on the same row; see memo_slot.  For the scalar USGS
+    // series only; the SIMD kernels are faster even so.
+    static bool memoLatitude;
+    static long memoHits, memoMisses;
+    
+    // Project from this zone straight to another, on the same 
+    // spheroid, by the Kruger series (see tmerc.cpp).
+    int toZone(TransverseMercator &to, double *xy, int count);
+    int toZone(TransverseMercator &to, double *x, double *y, int count);
    
   private:
+    int krugerFromLatLong(double *xy, int count);
+    int krugerToLatLong(double *xy, int count);
+    int krugerFromLatLong(double *x, double *y, int count);
+    int krugerToLatLong(double *x, double *y, int count);
+    
+    // SIMD kernels (tmvec.h); each does a multiple of its width
+    // of the points, and returns how many.
+    template <class Points> int fromLatLongSSE2(Points pts, int count);
+    template <class Points> int toLatLongSSE2(Points pts, int count);
+    template <class Points> int krugerFromLatLongSSE2(Points pts, int count);
+    template <class Points> int krugerToLatLongSSE2(Points pts, int count);
+    template <class Points> int toZoneSSE2(TransverseMercator &to, Points pts, int count);
+    template <class Points> int fastFromLatLongSSE2(Points pts, int count);
+    template <class Points> int fastToLatLongSSE2(Points pts, int count);
+    template <class Points> int fromLatLongAVX2(Points pts, int count);
+    template <class Points> int toLatLongAVX2(Points pts, int count);
+    template <class Points> int krugerFromLatLongAVX2(Points pts, int count);
+    template <class Points> int krugerToLatLongAVX2(Points pts, int count);
+    template <class Points> int toZoneAVX2(TransverseMercator &to, Points pts, int count);
+    template <class Points> int fastFromLatLongAVX2(Points pts, int count);
+    template <class Points> int fastToLatLongAVX2(Points pts, int count);
+    template <class Points> int fromLatLongAVX512(Points pts, int count);
+    template <class Points> int toLatLongAVX512(Points pts, int count);
+    template <class Points> int krugerFromLatLongAVX512(Points pts, int count);
+    template <class Points> int krugerToLatLongAVX512(Points pts, int count);
+    template <class Points> int toZoneAVX512(TransverseMercator &to, Points pts, int count);
+    template <class Points> int fastFromLatLongAVX512(Points pts, int count);
+    template <class Points> int fastToLatLongAVX512(Points pts, int count);
+    
     //Spheroid-specific values:
     double esq;
     double e1sq;
@@ -71,6 +121,20 @@ class TransverseMercator: public ProjectionBase {
     double lon0;
     
     double A0,A2,A4,A6,A8;
+    
+    // for the Kruger series
+    double e;                   // eccentricity
+    double rectA;               // radius of the rectifying sphere
+    double alpha[6], beta[6];   // to and from Gauss-Schreiber TM
+    double latSeries[6];        // conformal to geodetic latitude
+    
+    // for memoLatitude; a key of HUGE_VAL is an empty entry
+    enum { memoSize = 256 };
+    struct LatTerms { double lat, coslat, tanlat, N, T, C, M; };
+    struct FootTerms { double M, phi1, cosphi1, tanphi1, N1, T1, C1, R1; };
+    LatTerms latMemo[memoSize];
+    FootTerms footMemo[memoSize];
+    void clearMemo();
 };
 
 int PrepareMTM(TransverseMercator &tm, int zone, int atlantic=1);
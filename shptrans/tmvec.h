@@ -0,0 +1,502 @@
+/** 
+ * tmvec.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  SIMD versions of the USGS Bulletin 1532 Transverse Mercator, as in
+  tmerc.cpp, for VEC_WIDTH points at a time.  This is included by 
+  sse2.cpp, avx2.cpp and avx512.cpp, which are compiled for those
+  instruction sets and name the member functions through VEC_NAME; 
+  TransverseMercator picks one at run time.  Each handles the
+  largest multiple of VEC_WIDTH points, and returns how many that 
+  was, leaving the rest for the scalar code.
+  
+  The multiple-angle sines are built from one sincos with the double
+  angle formulae, rather than called for separately.
+  
+  The Kruger series follows the scalar versions closely.
+*/
+
+#include <math.h>
+#include "tmerc.h"
+#include "vecmath.h"
+
+template <class Points>
+int TransverseMercator::VEC_NAME(fromLatLong)(Points pts, int count) {
+    int done = count - count % VEC_WIDTH;
+    
+    for (int coordIdx=0; coordIdx<done; coordIdx+=VEC_WIDTH) {
+        vdouble lon, lat;
+        vec_load_pts(pts, coordIdx, &lon, &lat);
+        lon *= (PI/180);
+        lat *= (PI/180);
+        
+        vdouble sinlat, coslat;
+        vec_sincos(lat, &sinlat, &coslat);
+        vdouble tanlat = sinlat / coslat;
+        vdouble sinsqlat = sinlat * sinlat;
+        vdouble cossqlat = coslat * coslat;
+        
+        vdouble N = a / vec_sqrt(1 - esq * sinsqlat);
+        vdouble T = tanlat * tanlat;
+        vdouble C = e1sq * cossqlat;
+        vdouble Q = coslat * (lon - lon0);
+        vdouble Q2 = Q * Q;
+        vdouble Q3 = Q2 * Q;
+        vdouble Q4 = Q3 * Q;
+        vdouble Q5 = Q4 * Q;
+        vdouble Q6 = Q5 * Q;
+        
+        vdouble sin2 = 2 * sinlat * coslat, cos2 = cossqlat - sinsqlat;
+        vdouble sin4 = 2 * sin2 * cos2, cos4 = cos2 * cos2 - sin2 * sin2;
+        vdouble sin6 = sin4 * cos2 + cos4 * sin2;
+        vdouble sin8 = 2 * sin4 * cos4;
+        
+        vdouble M = a * (A0 * lat - A2 * sin2 + A4 * sin4 - A6 * sin6 + A8 * sin8);
+        
+        vdouble x = k0 * N * (Q + (1 - T + C) * Q3 / 6
+            + (5 - 18 * T + T * T + 72 * C - 58 * e1sq) * Q5 / 120)
+            + x0;
+        
+        vdouble y = k0 * (M + N * tanlat * (Q2 / 2 + (5 - T + 9 * C + 4 * C * C) * Q4 / 24
+            + (61 - 58 * T + T * T + 600 * C - 330 * e1sq) * Q6 / 720))
+            + y0;
+        
+        vec_store_pts(pts, coordIdx, x, y);
+    }
+    
+    return done;
+}
+
+template <class Points>
+int TransverseMercator::VEC_NAME(toLatLong)(Points pts, int count) {
+    int done = count - count % VEC_WIDTH;
+    
+    // stopping test as in toLatLong
+    const double errmax = angularTolerance();
+    const bool squared = (tolerance > 0);
+    const int maxiter = highPrecision ? 1000 : 100;
+    
+    vlong steps = vlong();
+    vdouble maxError = vdouble();
+    int maxSteps = 0;
+    
+    for (int coordIdx=0; coordIdx<done; coordIdx+=VEC_WIDTH) {
+        vdouble x, y;
+        vec_load_pts(pts, coordIdx, &x, &y);
+        x -= x0;
+        y -= y0;
+        
+        vdouble M = y / k0;
+        vdouble mu = M / (a * A0);
+        
+        vdouble s, c;
+        vec_sincos(2 * mu, &s, &c);
+        vdouble s4 = 2 * s * c, c4 = c * c - s * s;
+        vdouble s6 = s4 * c + c4 * s;
+        
+        vdouble phi1 = mu + (3*e1/2-27*e1*e1*e1/32) * s
+            + (21*e1*e1/16-55*e1*e1*e1*e1/32) * s4
+            + (151*e1*e1*e1/96) * s6;
+        
+        // Newton's method as in toLatLong; lanes stop changing once
+        // they have converged, and the loop ends when all have.
+        vlong active = vec_true();
+        vdouble last = vdouble();
+        int iter = 0;
+        do {
+            vdouble s2, c2;
+            vec_sincos(2 * phi1, &s2, &c2);
+            s4 = 2 * s2 * c2;
+            c4 = c2 * c2 - s2 * s2;
+            s6 = s4 * c2 + c4 * s2;
+            vdouble c6 = c4 * c2 - s4 * s2;
+            vdouble s8 = 2 * s4 * c4;
+            vdouble c8 = c4 * c4 - s4 * s4;
+            
+            vdouble eff = A0 * phi1 - A2 * s2 + A4 * s4 - A6 * s6 + A8 * s8 - M / a;
+            vdouble eff1 = A0 - 2 * A2 * c2 + 4 * A4 * c4 - 6 * A6 * c6 - 8 * A8 * c8;
+            
+            vdouble delta = vec_select(active, eff / eff1, vdouble());
+            phi1 -= delta;
+            steps -= active;
+            last = vec_select(active, delta * delta, last);
+            active &= (vlong)((squared ? delta * delta : vec_abs(delta)) > errmax);
+        } while (vec_any(active) && ++iter < maxiter);
+        if (iter < maxiter) ++iter;
+        if (iter > maxSteps) maxSteps = iter;
+        maxError = vec_select((vlong)(last > maxError), last, maxError);
+        
+        vdouble sinphi1, cosphi1;
+        vec_sincos(phi1, &sinphi1, &cosphi1);
+        vdouble tanphi1 = sinphi1 / cosphi1;
+        vdouble sinsqphi1 = sinphi1 * sinphi1;
+        vdouble cossqphi1 = cosphi1 * cosphi1;
+        
+        vdouble w = 1 - esq * sinsqphi1;
+        vdouble sqrtw = vec_sqrt(w);
+        vdouble N1 = a / sqrtw;
+        vdouble T1 = tanphi1 * tanphi1;
+        vdouble C1 = e1sq * cossqphi1;
+        vdouble R1 = a * (1 - esq) / (w * sqrtw);
+        vdouble D = x / (N1 * k0);
+        vdouble D2 = D * D;
+        
+        vdouble lat = phi1 - (N1 * tanphi1 / R1) * (
+                D2 / 2
+              - (5 + 3 * T1 + 10 * C1 - 4 * C1 * C1 - 9 * e1sq) * D2 * D2 / 24
+              + (61 + 90 * T1 + 298 * C1 + 45 * T1 * T1 - 252 * e1sq - 3 * C1 * C1) * D2 * D2 * D2 / 720
+            );
+        
+        vdouble lon = (
+            D - (1 + 2 * T1 + C1) * D2 * D / 6
+          + (5 - 2 * C1 + 28 * T1 - 3 * C1 * C1 + 8 * e1sq + 24 * T1 * T1) * D2 * D2 * D / 120
+        ) / cosphi1;
+        
+        vec_store_pts(pts, coordIdx, (lon + lon0) * (180/PI), lat * (180/PI));
+    }
+    
+    long total = 0;
+    double largest = 0;
+    for (int j = 0; j < VEC_WIDTH; ++j) {
+        total += steps[j];
+        if (maxError[j] > largest) largest = maxError[j];
+    }
+    addSolverStats(done, total, maxSteps, largest);
+    
+    return done;
+}
+
+
+
+// As clenshaw_complex in tmerc.cpp
+static inline void vec_clenshaw_complex(
+    double const *c, vdouble sin2xi, vdouble cos2xi, 
+    vdouble sinh2eta, vdouble cosh2eta, vdouble *xi, vdouble *eta
+) {
+    vdouble ar = 2 * cos2xi * cosh2eta;
+    vdouble ai = -2 * sin2xi * sinh2eta;
+    
+    vdouble y1r = vdouble(), y1i = vdouble(), y2r = vdouble(), y2i = vdouble();
+    for (int j = 5; j >= 0; --j) {
+        vdouble y0r = ar * y1r - ai * y1i - y2r + c[j];
+        vdouble y0i = ar * y1i + ai * y1r - y2i;
+        y2r = y1r; y2i = y1i;
+        y1r = y0r; y1i = y0i;
+    }
+    
+    vdouble sr = sin2xi * cosh2eta;
+    vdouble si = cos2xi * sinh2eta;
+    *xi  += sr * y1r - si * y1i;
+    *eta += sr * y1i + si * y1r;
+}
+
+template <class Points>
+int TransverseMercator::VEC_NAME(krugerFromLatLong)(Points pts, int count) {
+    int done = count - count % VEC_WIDTH;
+    
+    for (int coordIdx=0; coordIdx<done; coordIdx+=VEC_WIDTH) {
+        vdouble lon, lat;
+        vec_load_pts(pts, coordIdx, &lon, &lat);
+        lon = lon * (PI/180) - lon0;
+        lat *= (PI/180);
+        
+        vdouble sinlat, coslat, sinlon, coslon;
+        vec_sincos(lat, &sinlat, &coslat);
+        vec_sincos(lon, &sinlon, &coslon);
+        
+        vdouble tau = sinlat / coslat;
+        vdouble p = vec_exp((e / 2) * vec_log((1 + e * sinlat) / (1 - e * sinlat)));
+        vdouble sigma = (p - 1 / p) / 2;
+        vdouble taup = tau * vec_sqrt(1 + sigma * sigma) - sigma * vec_sqrt(1 + tau * tau);
+        
+        vdouble xi = vec_atan2(taup, coslon);
+        vdouble q = sinlon / vec_sqrt(taup * taup + coslon * coslon);
+        vdouble root = vec_sqrt(q * q + 1);
+        vdouble ex = vec_select((vlong)(q >= 0), q + root, 1 / (root - q));
+        vdouble eta = vec_log(ex);
+        
+        vdouble s2, c2;
+        vec_sincos(2 * xi, &s2, &c2);
+        ex *= ex;
+        vec_clenshaw_complex(alpha, s2, c2, (ex - 1 / ex) / 2, (ex + 1 / ex) / 2, &xi, &eta);
+        
+        vec_store_pts(pts, coordIdx, k0 * rectA * eta + x0, k0 * rectA * xi + y0);
+    }
+    
+    return done;
+}
+
+template <class Points>
+int TransverseMercator::VEC_NAME(krugerToLatLong)(Points pts, int count) {
+    int done = count - count % VEC_WIDTH;
+    
+    double minusBeta[6];
+    for (int j = 0; j < 6; ++j) minusBeta[j] = -beta[j];
+    
+    for (int coordIdx=0; coordIdx<done; coordIdx+=VEC_WIDTH) {
+        vdouble eta, xi;
+        vec_load_pts(pts, coordIdx, &eta, &xi);
+        eta = (eta - x0) / (k0 * rectA);
+        xi = (xi - y0) / (k0 * rectA);
+        
+        vdouble s2, c2;
+        vec_sincos(2 * xi, &s2, &c2);
+        vdouble ex = vec_exp(2 * eta);
+        vec_clenshaw_complex(minusBeta, s2, c2, (ex - 1 / ex) / 2, (ex + 1 / ex) / 2, &xi, &eta);
+        
+        vdouble sinxi, cosxi;
+        vec_sincos(xi, &sinxi, &cosxi);
+        ex = vec_exp(eta);
+        vdouble sinheta = (ex - 1 / ex) / 2;
+        vdouble chi = vec_atan2(sinxi, vec_sqrt(sinheta * sinheta + cosxi * cosxi));
+        vdouble lon = vec_atan2(sinheta, cosxi);
+        
+        vec_sincos(2 * chi, &s2, &c2);
+        vdouble a2 = 2 * c2;
+        vdouble b1 = vdouble(), b2 = vdouble();
+        for (int j = 5; j >= 0; --j) {
+            vdouble b0 = a2 * b1 - b2 + latSeries[j];
+            b2 = b1;
+            b1 = b0;
+        }
+        
+        vec_store_pts(pts, coordIdx, (lon + lon0) * (180/PI), (chi + s2 * b1) * (180/PI));
+    }
+    
+    return done;
+}
+
+template <class Points>
+int TransverseMercator::VEC_NAME(toZone)(TransverseMercator &to, Points pts, int count) {
+    int done = count - count % VEC_WIDTH;
+    
+    const double sinrot = sin(lon0 - to.lon0), cosrot = cos(lon0 - to.lon0);
+    
+    double minusBeta[6];
+    for (int j = 0; j < 6; ++j) minusBeta[j] = -beta[j];
+    
+    for (int coordIdx=0; coordIdx<done; coordIdx+=VEC_WIDTH) {
+        vdouble eta, xi;
+        vec_load_pts(pts, coordIdx, &eta, &xi);
+        eta = (eta - x0) / (k0 * rectA);
+        xi = (xi - y0) / (k0 * rectA);
+        
+        vdouble s2, c2;
+        vec_sincos(2 * xi, &s2, &c2);
+        vdouble ex = vec_exp(2 * eta);
+        vec_clenshaw_complex(minusBeta, s2, c2, (ex - 1 / ex) / 2, (ex + 1 / ex) / 2, &xi, &eta);
+        
+        vdouble sinxi, cosxi;
+        vec_sincos(xi, &sinxi, &cosxi);
+        ex = vec_exp(eta);
+        vdouble sinheta = (ex - 1 / ex) / 2;
+        vdouble r = vec_sqrt(sinheta * sinheta + cosxi * cosxi);
+        vdouble taup = sinxi / r;
+        vdouble coslon = (cosxi * cosrot - sinheta * sinrot) / r;
+        vdouble sinlon = (sinheta * cosrot + cosxi * sinrot) / r;
+        
+        xi = vec_atan2(taup, coslon);
+        vdouble q = sinlon / vec_sqrt(taup * taup + coslon * coslon);
+        vdouble root = vec_sqrt(q * q + 1);
+        ex = vec_select((vlong)(q >= 0), q + root, 1 / (root - q));
+        eta = vec_log(ex);
+        
+        vec_sincos(2 * xi, &s2, &c2);
+        ex *= ex;
+        vec_clenshaw_complex(to.alpha, s2, c2, (ex - 1 / ex) / 2, (ex + 1 / ex) / 2, &xi, &eta);
+        
+        vec_store_pts(pts, coordIdx, to.k0 * to.rectA * eta + to.x0, to.k0 * to.rectA * xi + to.y0);
+    }
+    
+    return done;
+}
+
+
+
+/*
+  The -fast versions, in single precision for 2 * VEC_WIDTH points at
+  a time.  The longitude is taken relative to the central meridian, 
+  and the leading term of the meridian arc is kept in double, so the
+  floats only carry what is small or relative to the zone; the false
+  offsets are added back in double.  The eighth-order terms of the
+  meridian arc (under 0.02mm) are left out, and the footpoint latitude
+  is taken from its series without Newton's method (within 0.1mm).
+  What is left is the rounding of the floats, relative to the distance
+  from the central meridian: up to 0.09m at 3 degrees, in either
+  direction.
+*/
+
+template <class Points>
+int TransverseMercator::VEC_NAME(fastFromLatLong)(Points pts, int count) {
+    int done = count - count % (2 * VEC_WIDTH);
+    
+    const double ky = k0 * a * A0;
+    
+    for (int coordIdx=0; coordIdx<done; coordIdx+=2*VEC_WIDTH) {
+        vdouble lon[2], lat[2];
+        vec_load_pts(pts, coordIdx, &lon[0], &lat[0]);
+        vec_load_pts(pts, coordIdx + VEC_WIDTH, &lon[1], &lat[1]);
+        for (int h = 0; h < 2; ++h) {
+            lon[h] = lon[h] * (PI/180) - lon0;
+            lat[h] *= (PI/180);
+        }
+        
+        vfloat dlon = vec_narrow(lon[0], lon[1]);
+        vfloat sinlat, coslat;
+        vecf_sincos(vec_narrow(lat[0], lat[1]), &sinlat, &coslat);
+        vfloat tanlat = sinlat / coslat;
+        vfloat sinsqlat = sinlat * sinlat;
+        vfloat cossqlat = coslat * coslat;
+        
+        vfloat N = (float)a / vecf_sqrt(1 - (float)esq * sinsqlat);
+        vfloat T = tanlat * tanlat;
+        vfloat C = (float)e1sq * cossqlat;
+        vfloat Q = coslat * dlon;
+        vfloat Q2 = Q * Q;
+        vfloat Q3 = Q2 * Q;
+        vfloat Q4 = Q3 * Q;
+        
+        vfloat sin2 = 2 * sinlat * coslat, cos2 = cossqlat - sinsqlat;
+        vfloat sin4 = 2 * sin2 * cos2, cos4 = cos2 * cos2 - sin2 * sin2;
+        vfloat sin6 = sin4 * cos2 + cos4 * sin2;
+        
+        // the meridian arc, less a * A0 * lat
+        vfloat M = (float)a * ((float)-A2 * sin2 + (float)A4 * sin4 - (float)A6 * sin6);
+        
+        vfloat x = (float)k0 * N * (Q + (1 - T + C) * Q3 / 6
+            + (5 - 18 * T + T * T + 72 * C - (float)(58 * e1sq)) * Q4 * Q / 120);
+        
+        vfloat y = (float)k0 * (M + N * tanlat * (Q2 / 2 + (5 - T + 9 * C + 4 * C * C) * Q4 / 24
+            + (61 - 58 * T + T * T + 600 * C - (float)(330 * e1sq)) * Q4 * Q2 / 720));
+        
+        vdouble xd[2], yd[2];
+        vec_widen(x, &xd[0], &xd[1]);
+        vec_widen(y, &yd[0], &yd[1]);
+        for (int h = 0; h < 2; ++h) {
+            vec_store_pts(pts, coordIdx + VEC_WIDTH*h, xd[h] + x0, yd[h] + (ky * lat[h] + y0));
+        }
+    }
+    
+    return done;
+}
+
+template <class Points>
+int TransverseMercator::VEC_NAME(fastToLatLong)(Points pts, int count) {
+    int done = count - count % (2 * VEC_WIDTH);
+    
+    const double kmu = 1 / (k0 * a * A0);
+    
+    for (int coordIdx=0; coordIdx<done; coordIdx+=2*VEC_WIDTH) {
+        vdouble x[2], mu[2];
+        vec_load_pts(pts, coordIdx, &x[0], &mu[0]);
+        vec_load_pts(pts, coordIdx + VEC_WIDTH, &x[1], &mu[1]);
+        for (int h = 0; h < 2; ++h) {
+            x[h] -= x0;
+            mu[h] = (mu[h] - y0) * kmu;
+        }
+        
+        vfloat muf = vec_narrow(mu[0], mu[1]);
+        vfloat s, c;
+        vecf_sincos(2 * muf, &s, &c);
+        vfloat s4 = 2 * s * c, c4 = c * c - s * s;
+        vfloat s6 = s4 * c + c4 * s;
+        
+        // the footpoint latitude, less mu
+        vfloat dphi = (float)(3*e1/2-27*e1*e1*e1/32) * s
+            + (float)(21*e1*e1/16-55*e1*e1*e1*e1/32) * s4
+            + (float)(151*e1*e1*e1/96) * s6;
+        
+        vfloat sinphi1, cosphi1;
+        vecf_sincos(muf + dphi, &sinphi1, &cosphi1);
+        vfloat tanphi1 = sinphi1 / cosphi1;
+        
+        vfloat w = 1 - (float)esq * sinphi1 * sinphi1;
+        vfloat sqrtw = vecf_sqrt(w);
+        vfloat N1 = (float)a / sqrtw;
+        vfloat T1 = tanphi1 * tanphi1;
+        vfloat C1 = (float)e1sq * cosphi1 * cosphi1;
+        vfloat R1 = (float)(a * (1 - esq)) / (w * sqrtw);
+        vfloat D = vec_narrow(x[0], x[1]) / (N1 * (float)k0);
+        vfloat D2 = D * D;
+        
+        vfloat lat = dphi - (N1 * tanphi1 / R1) * (
+                D2 / 2
+              - (5 + 3 * T1 + 10 * C1 - 4 * C1 * C1 - (float)(9 * e1sq)) * D2 * D2 / 24
+              + (61 + 90 * T1 + 298 * C1 + 45 * T1 * T1 - (float)(252 * e1sq) - 3 * C1 * C1) * D2 * D2 * D2 / 720
+            );
+        
+        vfloat lon = (
+            D - (1 + 2 * T1 + C1) * D2 * D / 6
+          + (5 - 2 * C1 + 28 * T1 - 3 * C1 * C1 + (float)(8 * e1sq) + 24 * T1 * T1) * D2 * D2 * D / 120
+        ) / cosphi1;
+        
+        vdouble latd[2], lond[2];
+        vec_widen(lat, &latd[0], &latd[1]);
+        vec_widen(lon, &lond[0], &lond[1]);
+        for (int h = 0; h < 2; ++h) {
+            vec_store_pts(pts, coordIdx + VEC_WIDTH*h, (lond[h] + lon0) * (180/PI), (latd[h] + mu[h]) * (180/PI));
+        }
+    }
+    
+    return done;
+}
+
+// both layouts (see PointPairs)
+template int TransverseMercator::VEC_NAME(fromLatLong)(PointPairs, int);
+template int TransverseMercator::VEC_NAME(fromLatLong)(PointArrays, int);
+template int TransverseMercator::VEC_NAME(toLatLong)(PointPairs, int);
+template int TransverseMercator::VEC_NAME(toLatLong)(PointArrays, int);
+template int TransverseMercator::VEC_NAME(krugerFromLatLong)(PointPairs, int);
+template int TransverseMercator::VEC_NAME(krugerFromLatLong)(PointArrays, int);
+template int TransverseMercator::VEC_NAME(krugerToLatLong)(PointPairs, int);
+template int TransverseMercator::VEC_NAME(krugerToLatLong)(PointArrays, int);
+template int TransverseMercator::VEC_NAME(toZone)(TransverseMercator &, PointPairs, int);
+template int TransverseMercator::VEC_NAME(toZone)(TransverseMercator &, PointArrays, int);
+template int TransverseMercator::VEC_NAME(fastFromLatLong)(PointPairs, int);
+template int TransverseMercator::VEC_NAME(fastFromLatLong)(PointArrays, int);
+template int TransverseMercator::VEC_NAME(fastToLatLong)(PointPairs, int);
+template int TransverseMercator::VEC_NAME(fastToLatLong)(PointArrays, int);
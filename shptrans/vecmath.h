@@ -0,0 +1,576 @@
+/** 
+ * vecmath.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  Math on short vectors of doubles, for the SIMD versions of the
+  projection kernels.  This relies on GCC vector extensions, and is
+  included once in each translation unit that is compiled for a 
+  particular instruction set, after defining VEC_WIDTH:
+  
+    2   SSE2           (compile with -msse2)
+    4   AVX2 and FMA   (compile with -mavx2 -mfma)
+    8   AVX-512        (compile with -mavx512f -mfma)
+  
+  Which of those to run is decided per call by the projections, from
+  ProjectionBase::simdLevel(); nothing here checks the CPU.
+  
+  Points are kept as separate vectors of x and y.  The kernels load
+  and store them with vec_load_pts and vec_store_pts, from separate
+  arrays of x and y (PointArrays) as they are, or from interleaved
+  pairs (PointPairs) through vec_load_xy and vec_store_xy, where the
+  lanes needn't hold the points in order, as every lane is worked on
+  alike.
+  
+  The error bounds given for each function are the largest seen in
+  10^7 random arguments over its domain, in units in the last place
+  of the correctly rounded result.  They are the same for each width,
+  give or take the rounding of fused multiply-adds.  tests/vectest.cpp
+  checks them, and times each function ("make test").  These functions
+  don't handle NaN, infinity or denormals as libm does, and don't set
+  errno; the projections never give them those.
+*/
+
+#ifndef _VECMATH_H
+#define _VECMATH_H
+
+#include <string.h>
+#include <immintrin.h>
+#include "projbase.h"
+
+#ifndef PI
+#define PI (3.1415926535897932384626433832795028842)
+#endif
+
+typedef double vdouble __attribute__ ((vector_size (VEC_WIDTH * 8)));
+typedef long long vlong __attribute__ ((vector_size (VEC_WIDTH * 8)));
+
+#if VEC_WIDTH == 2
+
+static const vlong vec_lo = { 0, 2 };
+static const vlong vec_hi = { 1, 3 };
+
+static inline vdouble vec_sqrt(vdouble x) {
+    return (vdouble)_mm_sqrt_pd((__m128d)x);
+}
+
+static inline bool vec_any(vlong m) {
+    return _mm_movemask_pd((__m128d)m) != 0;
+}
+
+#elif VEC_WIDTH == 4
+
+static const vlong vec_lo = { 0, 4, 2, 6 };
+static const vlong vec_hi = { 1, 5, 3, 7 };
+
+static inline vdouble vec_sqrt(vdouble x) {
+    return (vdouble)_mm256_sqrt_pd((__m256d)x);
+}
+
+static inline bool vec_any(vlong m) {
+    return _mm256_movemask_pd((__m256d)m) != 0;
+}
+
+#elif VEC_WIDTH == 8
+
+static const vlong vec_lo = { 0, 8, 2, 10, 4, 12, 6, 14 };
+static const vlong vec_hi = { 1, 9, 3, 11, 5, 13, 7, 15 };
+
+static inline vdouble vec_sqrt(vdouble x) {
+    return (vdouble)_mm512_sqrt_pd((__m512d)x);
+}
+
+static inline bool vec_any(vlong m) {
+    return _mm512_test_epi64_mask((__m512i)m, (__m512i)m) != 0;
+}
+
+#else
+#error VEC_WIDTH must be 2, 4 or 8
+#endif
+
+// VEC_WIDTH points from interleaved x,y pairs, and back.  vec_lo and
+// vec_hi are the unpack instructions (unpcklpd, unpckhpd), which stay
+// within each 128-bit lane: x gets the points of lo and hi alternately,
+// lane by lane, rather than in order, and the same shuffles of x and 
+// y put them back where they were.  Keeping them in order would take
+// permutes across lanes, for AVX2 and AVX-512, at about three times 
+// the cost.
+static inline void vec_load_xy(double const *xy, vdouble *x, vdouble *y) {
+    vdouble lo, hi;
+    memcpy(&lo, xy, sizeof lo);
+    memcpy(&hi, xy + VEC_WIDTH, sizeof hi);
+    *x = __builtin_shuffle(lo, hi, vec_lo);
+    *y = __builtin_shuffle(lo, hi, vec_hi);
+}
+
+static inline void vec_store_xy(double *xy, vdouble x, vdouble y) {
+    vdouble lo = __builtin_shuffle(x, y, vec_lo);
+    vdouble hi = __builtin_shuffle(x, y, vec_hi);
+    memcpy(xy, &lo, sizeof lo);
+    memcpy(xy + VEC_WIDTH, &hi, sizeof hi);
+}
+
+// VEC_WIDTH points from the i'th on, and back, in either layout
+static inline void vec_load_pts(PointPairs p, int i, vdouble *x, vdouble *y) {
+    vec_load_xy(p.xy + 2*i, x, y);
+}
+
+static inline void vec_load_pts(PointArrays p, int i, vdouble *x, vdouble *y) {
+    memcpy(x, p.x + i, sizeof *x);
+    memcpy(y, p.y + i, sizeof *y);
+}
+
+static inline void vec_store_pts(PointPairs p, int i, vdouble x, vdouble y) {
+    vec_store_xy(p.xy + 2*i, x, y);
+}
+
+static inline void vec_store_pts(PointArrays p, int i, vdouble x, vdouble y) {
+    memcpy(p.x + i, &x, sizeof x);
+    memcpy(p.y + i, &y, sizeof y);
+}
+
+static inline vdouble vec_splat(double v) {
+    return vdouble() + v;
+}
+
+static inline vlong vec_true() {
+    vlong m = {};
+    return ~m;
+}
+
+// a where m is set, otherwise b
+static inline vdouble vec_select(vlong m, vdouble a, vdouble b) {
+    return (vdouble)((m & (vlong)a) | (~m & (vlong)b));
+}
+
+static inline vdouble vec_abs(vdouble x) {
+    return (vdouble)((vlong)x & 0x7FFFFFFFFFFFFFFFLL);
+}
+
+// Conversions from small integers (|n| < 2^51) to doubles, through
+// the same 1.5 * 2^52 bias as in rounding.
+static inline vdouble vec_from_long(vlong n) {
+    const double bias = 6755399441055744.0;
+    return (vdouble)(n + 0x4338000000000000LL) - bias;
+}
+
+// Sine and cosine, by reduction to [-pi/4, pi/4] in three parts
+// (as in fdlibm) and the Cephes polynomials.  Within 1.6 ulp for
+// |theta| < 100, which covers the projections, and 2.5 ulp for
+// |theta| < 1e5.
+static inline void vec_sincos(vdouble theta, vdouble *s, vdouble *c) {
+    // adding 1.5 * 2^52 rounds to an integer, which is then also
+    // in the low bits of the representation
+    const double round = 6755399441055744.0;
+    vdouble q = theta * (2/PI) + round;
+    vlong quadrant = (vlong)q;
+    q -= round;
+    
+    vdouble r = theta - q * 1.57079632673412561417e+00;
+    r -= q * 6.07710050630396597660e-11;
+    r -= q * 2.02226624871116645580e-21;
+    
+    vdouble z = r * r;
+    vdouble sr = (((((
+          1.58962301576546568060E-10 * z
+        - 2.50507477628578072866E-8) * z
+        + 2.75573136213857245213E-6) * z
+        - 1.98412698295895385996E-4) * z
+        + 8.33333333332211858878E-3) * z
+        - 1.66666666666666307295E-1) * z * r + r;
+    vdouble cr = (((((
+         -1.13585365213876817300E-11 * z
+        + 2.08757008419747316778E-9) * z
+        - 2.75573141792967388112E-7) * z
+        + 2.48015872888517045348E-5) * z
+        - 1.38888888888730564116E-3) * z
+        + 4.16666666666665929218E-2) * z * z - 0.5 * z + 1.0;
+    
+    // odd quadrants swap sine and cosine; the sine is negated in
+    // quadrants 2 and 3, the cosine in quadrants 1 and 2
+    vlong odd = -(quadrant & 1);
+    vlong sinsign = (quadrant & 2) << 62;
+    vlong cossign = ((quadrant ^ (quadrant << 1)) & 2) << 62;
+    *s = (vdouble)((vlong)vec_select(odd, cr, sr) ^ sinsign);
+    *c = (vdouble)((vlong)vec_select(odd, sr, cr) ^ cossign);
+}
+
+
+// Natural log of x > 0 (normal, finite), by splitting off the 
+// exponent and the fdlibm polynomial for log((1+s)/(1-s)).
+// Within 0.9 ulp.
+static inline vdouble vec_log(vdouble x) {
+    vlong bits = (vlong)x;
+    vlong k = ((bits >> 52) & 0x7FF) - 1023;
+    vdouble m = (vdouble)((bits & 0x000FFFFFFFFFFFFFLL) | 0x3FF0000000000000LL);
+    
+    // keep m in [sqrt(1/2), sqrt(2))
+    vlong big = (vlong)(m > 1.41421356237309504880);
+    m = vec_select(big, m * 0.5, m);
+    k -= big;
+    
+    vdouble kd = vec_from_long(k);
+    vdouble f = m - 1;
+    vdouble s = f / (2 + f);
+    vdouble z = s * s;
+    vdouble R = ((((((
+          1.479819860511658591e-01 * z
+        + 1.531383769920937332e-01) * z
+        + 1.818357216161805012e-01) * z
+        + 2.222219843214978396e-01) * z
+        + 2.857142874366239149e-01) * z
+        + 3.999999999940941908e-01) * z
+        + 6.666666666666735130e-01) * z;
+    
+    // log(m) = f - s * (f - R), with ln 2 in two parts
+    return kd * 6.93147180369123816490e-01
+        + (f - (s * (f - R) - kd * 1.90821492927058770002e-10));
+}
+
+// e to the x, for |x| < 708, by reduction to |r| <= ln(2)/2 and the
+// Taylor series to r^13.  Within 1.2 ulp.
+static inline vdouble vec_exp(vdouble x) {
+    const double round = 6755399441055744.0;
+    vdouble q = x * 1.44269504088896340736 + round;
+    vlong k = (vlong)q - 0x4338000000000000LL;
+    q -= round;
+    
+    vdouble r = x - q * 6.93147180369123816490e-01;
+    r -= q * 1.90821492927058770002e-10;
+    
+    vdouble p = vec_splat(1.0 / 6227020800);
+    p = p * r + 1.0 / 479001600;
+    p = p * r + 1.0 / 39916800;
+    p = p * r + 1.0 / 3628800;
+    p = p * r + 1.0 / 362880;
+    p = p * r + 1.0 / 40320;
+    p = p * r + 1.0 / 5040;
+    p = p * r + 1.0 / 720;
+    p = p * r + 1.0 / 120;
+    p = p * r + 1.0 / 24;
+    p = p * r + 1.0 / 6;
+    p = p * r + 0.5;
+    p = (p * r + 1) * r + 1;
+    
+    return (vdouble)((vlong)p + (k << 52));
+}
+
+// Arc tangent, by the Cephes reduction to |x| <= 0.66 and rational
+// approximation.  Within 1 ulp.
+static inline vdouble vec_atan(vdouble x) {
+    vlong sign = (vlong)x & 0x8000000000000000LL;
+    x = vec_abs(x);
+    
+    // above tan(3 pi/8), atan(x) = pi/2 - atan(1/x); above 0.66,
+    // atan(x) = pi/4 + atan((x-1)/(x+1))
+    vlong big = (vlong)(x > 2.41421356237309504880);
+    vlong mid = (vlong)(x > 0.66) & ~big;
+    vdouble y = vec_select(big, vec_splat(PI/2),
+        vec_select(mid, vec_splat(PI/4), vdouble()));
+    vdouble morebits = vec_select(big, vec_splat(6.123233995736765886130E-17),
+        vec_select(mid, vec_splat(3.061616997868382943065E-17), vdouble()));
+    x = vec_select(big, -1 / x, vec_select(mid, (x - 1) / (x + 1), x));
+    
+    vdouble z = x * x;
+    vdouble P = (((
+        -8.750608600031904122785E-1 * z
+        - 1.615753718733365076637E1) * z
+        - 7.500855792314704667340E1) * z
+        - 1.228866684490136173410E2) * z
+        - 6.485021904942025371773E1;
+    vdouble Q = ((((
+          z
+        + 2.485846490142306297962E1) * z
+        + 1.650270098316988542046E2) * z
+        + 4.328810604912902668951E2) * z
+        + 4.853903996359136964868E2) * z
+        + 1.945506571482613964425E2;
+    
+    y += x * z * P / Q + x + morebits;
+    return (vdouble)((vlong)y ^ sign);
+}
+
+// Arc sine of |x| <= 1.  Within 2.5 ulp.
+static inline vdouble vec_asin(vdouble x) {
+    return vec_atan(x / vec_sqrt((1 - x) * (1 + x)));
+}
+
+// Tangent, as the quotient of vec_sincos.  Within 3.5 ulp for
+// |theta| < 100, and 4.5 ulp for |theta| < 1e5.
+static inline vdouble vec_tan(vdouble theta) {
+    vdouble s, c;
+    vec_sincos(theta, &s, &c);
+    return s / c;
+}
+
+// Arc tangent of y/x, in the quadrant of (x, y).  Within 1.6 ulp.
+static inline vdouble vec_atan2(vdouble y, vdouble x) {
+    vdouble t = vec_atan(y / x);
+    
+    // for x < 0, add pi with the sign of y
+    vlong neg = (vlong)(x < 0);
+    vlong ysign = (vlong)y & 0x8000000000000000LL;
+    vdouble pi = (vdouble)((vlong)vec_splat(PI) ^ ysign);
+    return t + vec_select(neg, pi, vdouble());
+}
+
+// x to the y, for x > 0, as exp(y * log(x)).  Within 4 ulp where 
+// |y log x| < 2, as in the projections; the error of the log grows
+// with |y log x|, so expect about that many ulp more beyond it.
+static inline vdouble vec_pow(vdouble x, vdouble y) {
+    return vec_exp(y * vec_log(x));
+}
+
+
+/*
+  Single precision, for the -fast kernels.  A vfloat fills the same
+  register as a vdouble, so it holds twice as many lanes; vec_narrow
+  and vec_widen convert between one vfloat and two vdoubles (the low
+  and high halves).  The kernels keep the large parts of each result
+  in double, and use these only for what is left, so the error is
+  relative to the smaller quantity.
+  
+  The bounds are in units in the last place of a float, found as for
+  the doubles above.  These are the Cephes single precision routines.
+*/
+
+typedef float vfloat __attribute__ ((vector_size (VEC_WIDTH * 8)));
+typedef int vint __attribute__ ((vector_size (VEC_WIDTH * 8)));
+
+#if VEC_WIDTH == 2
+
+static inline vfloat vecf_sqrt(vfloat x) {
+    return (vfloat)_mm_sqrt_ps((__m128)x);
+}
+
+static inline vfloat vec_narrow(vdouble lo, vdouble hi) {
+    return (vfloat)_mm_movelh_ps(_mm_cvtpd_ps((__m128d)lo), _mm_cvtpd_ps((__m128d)hi));
+}
+
+static inline void vec_widen(vfloat f, vdouble *lo, vdouble *hi) {
+    *lo = (vdouble)_mm_cvtps_pd((__m128)f);
+    *hi = (vdouble)_mm_cvtps_pd(_mm_movehl_ps((__m128)f, (__m128)f));
+}
+
+#elif VEC_WIDTH == 4
+
+static inline vfloat vecf_sqrt(vfloat x) {
+    return (vfloat)_mm256_sqrt_ps((__m256)x);
+}
+
+static inline vfloat vec_narrow(vdouble lo, vdouble hi) {
+    return (vfloat)_mm256_insertf128_ps(
+        _mm256_castps128_ps256(_mm256_cvtpd_ps((__m256d)lo)), 
+        _mm256_cvtpd_ps((__m256d)hi), 1);
+}
+
+static inline void vec_widen(vfloat f, vdouble *lo, vdouble *hi) {
+    *lo = (vdouble)_mm256_cvtps_pd(_mm256_castps256_ps128((__m256)f));
+    *hi = (vdouble)_mm256_cvtps_pd(_mm256_extractf128_ps((__m256)f, 1));
+}
+
+#elif VEC_WIDTH == 8
+
+static inline vfloat vecf_sqrt(vfloat x) {
+    return (vfloat)_mm512_sqrt_ps((__m512)x);
+}
+
+static inline vfloat vec_narrow(vdouble lo, vdouble hi) {
+    return (vfloat)_mm512_castpd_ps(_mm512_insertf64x4(
+        _mm512_castps_pd(_mm512_castps256_ps512(_mm512_cvtpd_ps((__m512d)lo))), 
+        _mm256_castps_pd(_mm512_cvtpd_ps((__m512d)hi)), 1));
+}
+
+static inline void vec_widen(vfloat f, vdouble *lo, vdouble *hi) {
+    *lo = (vdouble)_mm512_cvtps_pd(_mm512_castps512_ps256((__m512)f));
+    *hi = (vdouble)_mm512_cvtps_pd(_mm256_castpd_ps(
+        _mm512_extractf64x4_pd(_mm512_castps_pd((__m512)f), 1)));
+}
+
+#endif
+
+static inline vfloat vecf_splat(float v) {
+    return vfloat() + v;
+}
+
+// a where m is set, otherwise b
+static inline vfloat vecf_select(vint m, vfloat a, vfloat b) {
+    return (vfloat)((m & (vint)a) | (~m & (vint)b));
+}
+
+static inline vfloat vecf_abs(vfloat x) {
+    return (vfloat)((vint)x & 0x7FFFFFFF);
+}
+
+// Sine and cosine, reduced to [-pi/4, pi/4] as in vec_sincos.
+// Within 1.6 ulp for |theta| < 4, which covers the projections.
+// Further out, results near zero lose their low bits to the
+// reduction: about 6 ulp for |theta| < 16, and hundreds by 1000.
+static inline void vecf_sincos(vfloat theta, vfloat *s, vfloat *c) {
+    const float round = 12582912.0f; // 1.5 * 2^23
+    vfloat q = theta * (float)(2/PI) + round;
+    vint quadrant = (vint)q;
+    q -= round;
+    
+    vfloat r = theta - q * 1.5703125f;
+    r -= q * 4.837512969970703125e-4f;
+    r -= q * 7.549789948768648e-8f;
+    
+    vfloat z = r * r;
+    vfloat sr = ((
+         -1.9515295891E-4f * z
+        + 8.3321608736E-3f) * z
+        - 1.6666654611E-1f) * z * r + r;
+    vfloat cr = ((
+          2.443315711809948E-5f * z
+        - 1.388731625493765E-3f) * z
+        + 4.166664568298827E-2f) * z * z - 0.5f * z + 1.0f;
+    
+    vint odd = -(quadrant & 1);
+    vint sinsign = (quadrant & 2) << 30;
+    vint cossign = ((quadrant ^ (quadrant << 1)) & 2) << 30;
+    *s = (vfloat)((vint)vecf_select(odd, cr, sr) ^ sinsign);
+    *c = (vfloat)((vint)vecf_select(odd, sr, cr) ^ cossign);
+}
+
+// Natural log of x > 0 (normal, finite).  Within 0.8 ulp.
+static inline vfloat vecf_log(vfloat x) {
+    vint bits = (vint)x;
+    vint k = ((bits >> 23) & 0xFF) - 127;
+    vfloat m = (vfloat)((bits & 0x007FFFFF) | 0x3F800000);
+    
+    // keep m in [sqrt(1/2), sqrt(2))
+    vint big = (vint)(m > 1.41421356f);
+    m = vecf_select(big, m * 0.5f, m);
+    k -= big;
+    
+    vfloat kf = (vfloat)(k + 0x4B400000) - 12582912.0f;
+    vfloat f = m - 1;
+    vfloat z = f * f;
+    vfloat p = ((((((((
+          7.0376836292E-2f * f
+        - 1.1514610310E-1f) * f
+        + 1.1676998740E-1f) * f
+        - 1.2420140846E-1f) * f
+        + 1.4249322787E-1f) * f
+        - 1.6668057665E-1f) * f
+        + 2.0000714765E-1f) * f
+        - 2.4999993993E-1f) * f
+        + 3.3333331174E-1f) * f * z;
+    
+    // with ln 2 in two parts
+    return (p + kf * -2.12194440e-4f - 0.5f * z + f) + kf * 0.693359375f;
+}
+
+// e to the x, for |x| < 87.  Within 1.1 ulp.
+static inline vfloat vecf_exp(vfloat x) {
+    const float round = 12582912.0f;
+    vfloat q = x * 1.44269504088896341f + round;
+    vint k = (vint)q - 0x4B400000;
+    q -= round;
+    
+    vfloat r = x - q * 0.693359375f;
+    r -= q * -2.12194440e-4f;
+    
+    vfloat p = (((((
+          1.9875691500E-4f * r
+        + 1.3981999507E-3f) * r
+        + 8.3334519073E-3f) * r
+        + 4.1665795894E-2f) * r
+        + 1.6666665459E-1f) * r
+        + 5.0000001201E-1f) * r * r + r + 1;
+    
+    return (vfloat)((vint)p + (k << 23));
+}
+
+// Arc sine of |x| <= 1.  Within 2.4 ulp.
+static inline vfloat vecf_asin(vfloat x) {
+    vint sign = (vint)x & 0x80000000;
+    vfloat a = vecf_abs(x);
+    
+    // above 0.5, asin(a) = pi/2 - 2 asin(sqrt((1-a)/2))
+    vint big = (vint)(a > 0.5f);
+    vfloat z = vecf_select(big, 0.5f * (1 - a), a * a);
+    a = vecf_select(big, vecf_sqrt(z), a);
+    
+    vfloat p = ((((
+          4.2163199048E-2f * z
+        + 2.4181311049E-2f) * z
+        + 4.5470025998E-2f) * z
+        + 7.4953002686E-2f) * z
+        + 1.6666752422E-1f) * z * a + a;
+    p = vecf_select(big, (float)(PI/2) - (p + p), p);
+    return (vfloat)((vint)p ^ sign);
+}
+
+// atanh(x), for |x| < 1.  Small arguments, where the log would lose
+// their low bits, are summed as a series instead.  Within 2.8 ulp.
+static inline vfloat vecf_atanh(vfloat x) {
+    vfloat z = x * x;
+    vfloat series = (((((
+          z * (1.0f/11)
+        + 1.0f/9) * z
+        + 1.0f/7) * z
+        + 1.0f/5) * z
+        + 1.0f/3) * z) * x + x;
+    vfloat logs = 0.5f * vecf_log((1 + x) / (1 - x));
+    return vecf_select((vint)(z < 0.0625f), series, logs);
+}
+
+// sinh(x), for |x| < 87, likewise.  Within 2.6 ulp.
+static inline vfloat vecf_sinh(vfloat x) {
+    vfloat z = x * x;
+    vfloat series = ((((
+          z * (1.0f/362880)
+        + 1.0f/5040) * z
+        + 1.0f/120) * z
+        + 1.0f/6) * z) * x + x;
+    vfloat e = vecf_exp(x);
+    vfloat exps = 0.5f * (e - 1 / e);
+    return vecf_select((vint)(z < 0.25f), series, exps);
+}
+
+#endif
@@ -0,0 +1,172 @@
+/** 
+ * webmerc.cpp - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+#include "webmerc.h"
+
+#include <math.h>
+#include "math87.h"
+
+
+const double WebMercator::radius = 6378137.0;
+const double WebMercator::maxLatitude = 85.051128779806592;
+
+
+int WebMercator::setTileZoom(int z) {
+    if (z < -1 || z > 30) return PROJ_E_PARAM;
+    
+    zoom = z;
+    if (zoom < 0) {
+        k0 = 1;
+        x0 = y0 = 0;
+    } else {
+        // The world is 256 * 2^zoom pixels across, and as high,
+        // with its centre at (0,0) in meters.  (The scale is set 
+        // directly, as it is far below what setScaleFactor allows.)
+        double size = 256.0 * (1L << zoom);
+        k0 = size / (2 * PI * radius);
+        x0 = y0 = size / 2;
+    }
+    return PROJ_SUCCESS;
+}
+
+
+/*
+  Forward, y = R * ln tan(pi/4 + lat/2), which is R * atanh(sin lat); 
+  reverse, lat = atan(sinh(y / R)).  Neither needs a series or any
+  iteration.  For tile pixels, y is down rather than up, and the
+  pixel is the floor of the position.
+*/
+
+int WebMercator::fromLatLong(double *xy, int numPoints)
+{
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = fromLatLongAVX512(PointPairs(xy), numPoints); break;
+      case SIMD_AVX2: done = fromLatLongAVX2(PointPairs(xy), numPoints); break;
+      case SIMD_SSE2: done = fromLatLongSSE2(PointPairs(xy), numPoints); break;
+    }
+    xy += 2 * done;
+    numPoints -= done;
+#endif
+    const double kr = k0 * radius;
+    const double ky = (zoom < 0) ? kr : -kr;
+    
+    for (int i=0;i<numPoints;++i,xy+=2) {
+        double lat = xy[1];
+        if (lat > maxLatitude) lat = maxLatitude;
+        if (lat < -maxLatitude) lat = -maxLatitude;
+        
+        double sin_lat = sin(lat * (PI/180));
+        
+        xy[0] = x0 + kr * (xy[0] * (PI/180));
+        xy[1] = y0 + ky * 0.5 * log((1 + sin_lat) / (1 - sin_lat));
+        
+        if (zoom >= 0) {
+            xy[0] = floor(xy[0]);
+            xy[1] = floor(xy[1]);
+        }
+    }
+    
+    return PROJ_SUCCESS;
+}
+
+
+int WebMercator::toLatLong(double *xy, int numPoints)
+{
+#ifdef HAVE_SIMD_KERNELS
+    int done = 0;
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = toLatLongAVX512(PointPairs(xy), numPoints); break;
+      case SIMD_AVX2: done = toLatLongAVX2(PointPairs(xy), numPoints); break;
+      case SIMD_SSE2: done = toLatLongSSE2(PointPairs(xy), numPoints); break;
+    }
+    xy += 2 * done;
+    numPoints -= done;
+#endif
+    const double kr = k0 * radius;
+    const double ky = (zoom < 0) ? kr : -kr;
+    const double centre = (zoom < 0) ? 0 : 0.5;
+    
+    for (int i=0;i<numPoints;++i,xy+=2) {
+        double lon = (xy[0] + centre - x0) / kr;
+        double lat = atan(sinh((xy[1] + centre - y0) / ky));
+        
+        xy[0] = lon * (180/PI);
+        xy[1] = lat * (180/PI);
+    }
+    
+    return PROJ_SUCCESS;
+}
+
+
+// For separate arrays of x and y: the same kernels, reading the
+// arrays directly, with the last few points left to ProjectionBase.
+int WebMercator::fromLatLong(double *x, double *y, int numPoints)
+{
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = fromLatLongAVX512(PointArrays(x, y), numPoints); break;
+      case SIMD_AVX2: done = fromLatLongAVX2(PointArrays(x, y), numPoints); break;
+      case SIMD_SSE2: done = fromLatLongSSE2(PointArrays(x, y), numPoints); break;
+    }
+#endif
+    return ProjectionBase::fromLatLong(x + done, y + done, numPoints - done);
+}
+
+int WebMercator::toLatLong(double *x, double *y, int numPoints)
+{
+    int done = 0;
+#ifdef HAVE_SIMD_KERNELS
+    switch (simdLevel()) {
+      case SIMD_AVX512: done = toLatLongAVX512(PointArrays(x, y), numPoints); break;
+      case SIMD_AVX2: done = toLatLongAVX2(PointArrays(x, y), numPoints); break;
+      case SIMD_SSE2: done = toLatLongSSE2(PointArrays(x, y), numPoints); break;
+    }
+#endif
+    return ProjectionBase::toLatLong(x + done, y + done, numPoints - done);
+}
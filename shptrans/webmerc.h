@@ -0,0 +1,101 @@
+/** 
+ * webmerc.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+#ifndef _WEBMERC_H
+#define _WEBMERC_H
+
+#include "projbase.h"
+
+
+// Web Mercator, as used by web maps: the Mercator projection of 
+// latitude and longitude, taken as if on a sphere with the radius 
+// of the WGS 84 semi-major axis, whatever the spheroid.  (So on 
+// NAD83 it is near enough EPSG:3857; on another datum it is that 
+// datum's latitude and longitude, projected the same way.)
+class WebMercator: public ProjectionBase {
+  protected:
+    int zoom;           // for tile pixels, or -1 for meters
+    
+    int spheroidChanged() { return PROJ_SUCCESS; }
+    
+    // SIMD kernels (wmvec.h); each does a multiple of its width
+    // of the points, and returns how many.
+    template <class Points> int fromLatLongSSE2(Points pts, int numPoints);
+    template <class Points> int toLatLongSSE2(Points pts, int numPoints);
+    template <class Points> int fromLatLongAVX2(Points pts, int numPoints);
+    template <class Points> int toLatLongAVX2(Points pts, int numPoints);
+    template <class Points> int fromLatLongAVX512(Points pts, int numPoints);
+    template <class Points> int toLatLongAVX512(Points pts, int numPoints);
+  
+  public:
+  
+    int fromLatLong( double *xy, int numPoints);
+    int toLatLong( double *xy, int numPoints);
+    int fromLatLong( double *x, double *y, int numPoints);
+    int toLatLong( double *x, double *y, int numPoints);
+    
+    // Instead of meters, give whole pixels at this zoom level (0 to
+    // 30), counted from the top left of the world, 256 to a tile:
+    // the tile is the pixel over 256, and the pixel within it the 
+    // remainder.  A pixel is taken back to its centre.  This sets 
+    // the scale factor and false offsets; -1 goes back to meters.
+    int setTileZoom(int zoom);
+    int getTileZoom() { return zoom; }
+    
+    // the sphere's radius, and the latitude at which the projection
+    // is square (y = pi * radius); latitudes beyond are clipped to it
+    static const double radius;
+    static const double maxLatitude;
+  
+    WebMercator(): zoom(-1) {}
+  
+  // Plain ol' data so no need for destructor, copy ctor, oper=
+};
+
+
+#endif
+
@@ -0,0 +1,123 @@
+/** 
+ * wmvec.h - published as part of SHPTRANS
+ *
+ *
+ * SHPTRANS is Copyright (c) 1999-2004 Bruce Dodson and others.
+ * All rights Reserved.
+ * 
+ * Permission to use, copy, modify, merge, publish, perform,
+ * distribute, sublicense, and/or sell copies of this original work
+ * of authorship (the "Software") and derivative works thereof, is 
+ * hereby granted free of charge to any person obtaining a copy of 
+ * the Software, subject to the following conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimers.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ *    notice, this list of conditions and the following disclaimers in 
+ *    the documentation and/or other materials provided with the 
+ *    distribution.
+ *
+ * 3. Neither the names of the copyright holders, nor the names of any
+ *    contributing authors, may be used to endorse or promote products
+ *    derived from the Software without specific prior written
+ *    permission.
+ *
+ * 4. If you modify a copy of the Software, or any portion thereof,
+ *    you must cause the modified files to carry prominent notices 
+ *    stating that you changed the files.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND.
+ * THE COPYRIGHT HOLDERS AND CONTRIBUTING AUTHORS DISCLAIM ANY AND
+ * ALL WARRANTIES, WHETHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR
+ * A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTING AUTHORS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING IN ANY WAY OUT OF THE USE
+ * OR DISTRIBUTION OF THE SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+**/
+
+
+
+/*
+  SIMD versions of Web Mercator, as in webmerc.cpp, for VEC_WIDTH 
+  points at a time; included by sse2.cpp, avx2.cpp and avx512.cpp 
+  in the same way as tmvec.h.
+*/
+
+#include <math.h>
+#include "webmerc.h"
+#include "vecmath.h"
+
+// the largest integer not above x, for |x| < 2^51
+static inline vdouble vec_floor(vdouble x) {
+    const double round = 6755399441055744.0;
+    vdouble q = (x + round) - round;
+    return vec_select((vlong)(q > x), q - 1, q);
+}
+
+template <class Points>
+int WebMercator::VEC_NAME(fromLatLong)(Points pts, int count) {
+    int done = count - count % VEC_WIDTH;
+    
+    const double kr = k0 * radius;
+    const double ky = (zoom < 0) ? kr : -kr;
+    
+    for (int i=0; i<done; i+=VEC_WIDTH) {
+        vdouble lon, lat;
+        vec_load_pts(pts, i, &lon, &lat);
+        lat = vec_select((vlong)(lat > maxLatitude), vec_splat(maxLatitude), lat);
+        lat = vec_select((vlong)(lat < -maxLatitude), vec_splat(-maxLatitude), lat);
+        
+        vdouble sin_lat, cos_lat;
+        vec_sincos(lat * (PI/180), &sin_lat, &cos_lat);
+        
+        vdouble x = x0 + kr * (lon * (PI/180));
+        vdouble y = y0 + ky * 0.5 * vec_log((1 + sin_lat) / (1 - sin_lat));
+        
+        if (zoom >= 0) {
+            x = vec_floor(x);
+            y = vec_floor(y);
+        }
+        
+        vec_store_pts(pts, i, x, y);
+    }
+    
+    return done;
+}
+
+template <class Points>
+int WebMercator::VEC_NAME(toLatLong)(Points pts, int count) {
+    int done = count - count % VEC_WIDTH;
+    
+    const double kr = k0 * radius;
+    const double ky = (zoom < 0) ? kr : -kr;
+    const double centre = (zoom < 0) ? 0 : 0.5;
+    
+    for (int i=0; i<done; i+=VEC_WIDTH) {
+        vdouble x, y;
+        vec_load_pts(pts, i, &x, &y);
+        
+        // atan(sinh(t)), with sinh from one exp
+        vdouble u = vec_exp((y + centre - y0) / ky);
+        vdouble lat = vec_atan(0.5 * (u - 1 / u));
+        
+        vec_store_pts(pts, i, 
+            ((x + centre - x0) / kr) * (180/PI),
+            lat * (180/PI));
+    }
+    
+    return done;
+}
+
+// both layouts (see PointPairs)
+template int WebMercator::VEC_NAME(fromLatLong)(PointPairs, int);
+template int WebMercator::VEC_NAME(fromLatLong)(PointArrays, int);
+template int WebMercator::VEC_NAME(toLatLong)(PointPairs, int);
+template int WebMercator::VEC_NAME(toLatLong)(PointArrays, int);